@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/blackboard.h"
+#include "behaviortree_cpp/scripting/script_parser.hpp"
+
+using BT::Any;
+
+//------------------------------------------------------------
+// Any, in isolation
+
+static void BM_AnyCopyDouble(benchmark::State& state)
+{
+  const Any value(3.14);
+  for(auto _ : state)
+  {
+    Any copy(value);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_AnyCopyDouble);
+
+static void BM_AnyCopyShortString(benchmark::State& state)
+{
+  const Any value(std::string("hello"));
+  for(auto _ : state)
+  {
+    Any copy(value);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_AnyCopyShortString);
+
+static void BM_AnyCopyLongString(benchmark::State& state)
+{
+  const Any value(std::string("this string does not fit in the small buffer"));
+  for(auto _ : state)
+  {
+    Any copy(value);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_AnyCopyLongString);
+
+static void BM_AnyCopyVector(benchmark::State& state)
+{
+  const Any value(std::vector<double>{ 1, 2, 3, 4 });
+  for(auto _ : state)
+  {
+    Any copy(value);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_AnyCopyVector);
+
+static void BM_AnyCastDouble(benchmark::State& state)
+{
+  const Any value(3.14);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(value.cast<double>());
+  }
+}
+BENCHMARK(BM_AnyCastDouble);
+
+static void BM_AnyCastIntToDouble(benchmark::State& state)
+{
+  const Any value(42);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(value.cast<double>());
+  }
+}
+BENCHMARK(BM_AnyCastIntToDouble);
+
+static void BM_AnyCastStringToInt(benchmark::State& state)
+{
+  const Any value(std::string("12345"));
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(value.cast<int>());
+  }
+}
+BENCHMARK(BM_AnyCastStringToInt);
+
+//------------------------------------------------------------
+// Blackboard workloads
+
+static void BM_BlackboardSetGetInt(benchmark::State& state)
+{
+  auto bb = BT::Blackboard::create();
+  bb->set("value", 0);
+  int i = 0;
+  for(auto _ : state)
+  {
+    bb->set("value", i++);
+    benchmark::DoNotOptimize(bb->get<int>("value"));
+  }
+}
+BENCHMARK(BM_BlackboardSetGetInt);
+
+static void BM_BlackboardSetGetString(benchmark::State& state)
+{
+  auto bb = BT::Blackboard::create();
+  const std::string str = "a string longer than fifteen characters";
+  bb->set("value", str);
+  for(auto _ : state)
+  {
+    bb->set("value", str);
+    benchmark::DoNotOptimize(bb->get<std::string>("value"));
+  }
+}
+BENCHMARK(BM_BlackboardSetGetString);
+
+static void BM_BlackboardSetGetVector(benchmark::State& state)
+{
+  auto bb = BT::Blackboard::create();
+  const std::vector<double> vect = { 1, 2, 3, 4 };
+  bb->set("value", vect);
+  for(auto _ : state)
+  {
+    bb->set("value", vect);
+    benchmark::DoNotOptimize(bb->get<std::vector<double>>("value"));
+  }
+}
+BENCHMARK(BM_BlackboardSetGetVector);
+
+//------------------------------------------------------------
+// Scripting workloads
+
+static void BM_ScriptArithmetic(benchmark::State& state)
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(), {} };
+  env.vars->set("A", 1.5);
+  env.vars->set("B", 2);
+  auto executor = BT::ParseScript("C := A * B + 3.0 / (A - 1)").value();
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(executor(env));
+  }
+}
+BENCHMARK(BM_ScriptArithmetic);
+
+static void BM_ScriptComparison(benchmark::State& state)
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(), {} };
+  env.vars->set("A", 10);
+  env.vars->set("B", 20.0);
+  auto executor = BT::ParseScript("A < B && B != 0").value();
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(executor(env));
+  }
+}
+BENCHMARK(BM_ScriptComparison);
+
+static void BM_ScriptStringCompare(benchmark::State& state)
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(), {} };
+  env.vars->set("state", std::string("NAVIGATING_TO_CHARGING_STATION"));
+  auto executor = BT::ParseScript("state == 'NAVIGATING_TO_CHARGING_STATION'").value();
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(executor(env));
+  }
+}
+BENCHMARK(BM_ScriptStringCompare);
+
+static void BM_ScriptStrings(benchmark::State& state)
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(), {} };
+  env.vars->set("name", std::string("a string longer than fifteen characters"));
+  auto executor = BT::ParseScript("msg := name .. '_suffix'").value();
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(executor(env));
+  }
+}
+BENCHMARK(BM_ScriptStrings);
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <clocale>
+#include <sstream>
+
+#include "behaviortree_cpp/basic_types.h"
+
+using BT::StringView;
+
+// Conversion from string, as it was implemented before the introduction
+// of forEachSplit() and std::from_chars, used as reference
+namespace Legacy
+{
+std::vector<StringView> splitString(const StringView& strToSplit, char delimeter)
+{
+  std::vector<StringView> splitted_strings;
+  splitted_strings.reserve(4);
+
+  size_t pos = 0;
+  while(pos < strToSplit.size())
+  {
+    size_t new_pos = strToSplit.find_first_of(delimeter, pos);
+    if(new_pos == std::string::npos)
+    {
+      new_pos = strToSplit.size();
+    }
+    splitted_strings.push_back(StringView{ &strToSplit.data()[pos], new_pos - pos });
+    pos = new_pos + 1;
+  }
+  return splitted_strings;
+}
+
+double toDouble(StringView str)
+{
+  std::string old_locale = setlocale(LC_NUMERIC, nullptr);
+  setlocale(LC_NUMERIC, "C");
+  double val = std::stod(str.data());
+  setlocale(LC_NUMERIC, old_locale.c_str());
+  return val;
+}
+
+std::vector<double> toVectorDouble(StringView str)
+{
+  auto parts = splitString(str, ';');
+  std::vector<double> output;
+  output.reserve(parts.size());
+  for(const StringView& part : parts)
+  {
+    output.push_back(toDouble(part));
+  }
+  return output;
+}
+
+std::vector<int> toVectorInt(StringView str)
+{
+  auto parts = splitString(str, ';');
+  std::vector<int> output;
+  output.reserve(parts.size());
+  for(const StringView& part : parts)
+  {
+    output.push_back(BT::convertFromString<int>(part));
+  }
+  return output;
+}
+}  // namespace Legacy
+
+static std::string makeList(size_t count, bool floating_point)
+{
+  std::ostringstream ss;
+  for(size_t i = 0; i < count; i++)
+  {
+    if(i > 0)
+    {
+      ss << ';';
+    }
+    if(floating_point)
+    {
+      ss << (double(i) * 0.37 - 100.0);
+    }
+    else
+    {
+      ss << (int(i) * 7 - 1000);
+    }
+  }
+  return ss.str();
+}
+
+static void BM_VectorDouble(benchmark::State& state)
+{
+  const auto str = makeList(size_t(state.range(0)), true);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(BT::convertFromString<std::vector<double>>(str));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorDouble)->Arg(4)->Arg(64)->Arg(1024);
+
+static void BM_VectorDoubleLegacy(benchmark::State& state)
+{
+  const auto str = makeList(size_t(state.range(0)), true);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(Legacy::toVectorDouble(str));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorDoubleLegacy)->Arg(4)->Arg(64)->Arg(1024);
+
+static void BM_VectorInt(benchmark::State& state)
+{
+  const auto str = makeList(size_t(state.range(0)), false);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(BT::convertFromString<std::vector<int>>(str));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorInt)->Arg(4)->Arg(64)->Arg(1024);
+
+static void BM_VectorIntLegacy(benchmark::State& state)
+{
+  const auto str = makeList(size_t(state.range(0)), false);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(Legacy::toVectorInt(str));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorIntLegacy)->Arg(4)->Arg(64)->Arg(1024);
+
+static void BM_Double(benchmark::State& state)
+{
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(BT::convertFromString<double>("-123.456"));
+  }
+}
+BENCHMARK(BM_Double);
+
+static void BM_DoubleLegacy(benchmark::State& state)
+{
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(Legacy::toDouble("-123.456"));
+  }
+}
+BENCHMARK(BM_DoubleLegacy);
@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/scripting/operators.hpp"
+#include "behaviortree_cpp/scripting/script_bytecode.hpp"
+#include "behaviortree_cpp/bt_factory.h"
+
+#include <lexy/action/parse.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy_ext/report_error.hpp>
+
+// Compare the evaluation of the AST with the execution of the bytecode
+
+static BT::Ast::Environment MakeEnvironment()
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(),
+                               std::make_shared<BT::EnumsTable>() };
+  env.enums->insert({ "RED", 1 });
+  env.enums->insert({ "GREEN", 2 });
+  env.enums->insert({ "LOW_BATTERY", 20 });
+  env.enums->insert({ "IDLE", 0 });
+  env.vars->set("A", 10);
+  env.vars->set("B", 2.5);
+  env.vars->set("color", 2);
+  env.vars->set("x", 0.0);
+  env.vars->set("battery", 50);
+  env.vars->set("state", 0);
+  return env;
+}
+
+static BT::Ast::expr_ptr ParseExpression(const char* text)
+{
+  auto input = lexy::zstring_input<lexy::utf8_encoding>(text);
+  auto result = lexy::parse<BT::Grammar::stmt>(input, lexy_ext::report_error);
+  return LEXY_MOV(result).value().front();
+}
+
+static const char* SCRIPTS[] = { "A > 3 && B < 5.0",
+                                 "color == GREEN || A < 0",
+                                 "0 < A < 100",
+                                 "x := A * B + (A - 1) / 3",
+                                 "A > 5 ? B * 2 : B / 2",
+                                 "(A & 3) == 2 && !(B > 10) && A != 0",
+                                 "battery > LOW_BATTERY && state == IDLE" };
+
+static void BM_ScriptAST(benchmark::State& state)
+{
+  auto env = MakeEnvironment();
+  auto expr = ParseExpression(SCRIPTS[state.range(0)]);
+  state.SetLabel(SCRIPTS[state.range(0)]);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(expr->evaluate(env));
+  }
+}
+BENCHMARK(BM_ScriptAST)->DenseRange(0, 6);
+
+static void BM_ScriptBytecode(benchmark::State& state)
+{
+  auto env = MakeEnvironment();
+  auto expr = ParseExpression(SCRIPTS[state.range(0)]);
+  auto bytecode = BT::Ast::ScriptBytecode::compile(expr);
+  state.SetLabel(SCRIPTS[state.range(0)]);
+  BT::Any result;
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(bytecode->execute(env, result));
+  }
+}
+BENCHMARK(BM_ScriptBytecode)->DenseRange(0, 6);
+
+// enums folded at compilation time and blackboard entries bound once
+static void BM_ScriptBytecodeLinked(benchmark::State& state)
+{
+  auto env = MakeEnvironment();
+  auto expr = ParseExpression(SCRIPTS[state.range(0)]);
+  auto bytecode = BT::Ast::ScriptBytecode::compile(expr, env.enums.get());
+  BT::Ast::ScriptBytecode::Bindings bindings;
+  state.SetLabel(SCRIPTS[state.range(0)]);
+  BT::Any result;
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(bytecode->execute(env, result, &bindings));
+  }
+}
+BENCHMARK(BM_ScriptBytecodeLinked)->DenseRange(0, 6);
+
+// Many instances of a subtree with the same scripts.
+// With the cache, each script is parsed only once.
+static const char* xml_scripts = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="Main">
+    <Sequence>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+      <Repeat num_cycles="1"> <SubTree ID="Sub" _autoremap="true"/> </Repeat>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Sub">
+    <Sequence>
+      <Script code="counter := 0; limit := 10 * 2 + 5" />
+      <Script code="counter += 1" _skipIf="counter > limit" _while="limit != 0" />
+      <ScriptCondition code="counter > 0 && counter <= limit" />
+      <Script code="message := 'done'" _successIf="counter == limit" _post="counter = 0" />
+    </Sequence>
+  </BehaviorTree>
+</root>)";
+
+static void BM_CreateTreeWithScripts(benchmark::State& state)
+{
+  const bool use_cache = state.range(0) != 0;
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_scripts);
+  state.SetLabel(use_cache ? "cached" : "cleared cache");
+  for(auto _ : state)
+  {
+    if(!use_cache)
+    {
+      BT::ClearScriptCache();
+    }
+    benchmark::DoNotOptimize(factory.createTree("Main"));
+  }
+}
+BENCHMARK(BM_CreateTreeWithScripts)->Arg(0)->Arg(1);
+
+// Built-in functions over an array stored in the blackboard
+static const char* ARRAY_SCRIPTS[] = { "min(scan)", "sum(scan)", "dot(scan, scan)",
+                                       "any(scan < 0.1)" };
+
+static void BM_ScriptArrayFunction(benchmark::State& state)
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(), {} };
+  std::vector<double> scan(size_t(state.range(1)));
+  for(size_t i = 0; i < scan.size(); i++)
+  {
+    scan[i] = 1.0 + double(i % 100) / 10.0;
+  }
+  env.vars->set("scan", scan);
+  auto script = BT::ParseScript(ARRAY_SCRIPTS[state.range(0)]).value();
+  state.SetLabel(ARRAY_SCRIPTS[state.range(0)]);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(script(env));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_ScriptArrayFunction)->ArgsProduct({ { 0, 1, 2, 3 }, { 16, 1024 } });
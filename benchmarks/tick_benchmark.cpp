@@ -0,0 +1,233 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/static_tree.h"
+
+// Overhead of TreeNode::executeTick() for nodes with and without
+// pre/post conditions.
+
+static std::string MakeTree(const char* attributes)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="Main"><Sequence>)";
+  for(int i = 0; i < 100; i++)
+  {
+    xml += "<AlwaysSuccess ";
+    xml += attributes;
+    xml += "/>";
+  }
+  xml += "</Sequence></BehaviorTree></root>";
+  return xml;
+}
+
+static void TickTree(benchmark::State& state, const char* attributes)
+{
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(MakeTree(attributes));
+  tree.rootBlackboard()->set("value", 1);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickOnce());
+  }
+  state.SetItemsProcessed(state.iterations() * 100);
+}
+
+static void BM_TickWithoutConditions(benchmark::State& state)
+{
+  TickTree(state, "");
+}
+BENCHMARK(BM_TickWithoutConditions);
+
+static void BM_TickWithPrecondition(benchmark::State& state)
+{
+  TickTree(state, R"(_failureIf="value > 10")");
+}
+BENCHMARK(BM_TickWithPrecondition);
+
+static void BM_TickWithPostcondition(benchmark::State& state)
+{
+  TickTree(state, R"(_onSuccess="value = 1")");
+}
+BENCHMARK(BM_TickWithPostcondition);
+
+// The same control flow, composed at compile time or interpreted
+namespace
+{
+struct Success
+{
+  BT::NodeStatus tick(BT::TreeNode&)
+  {
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+struct Failure
+{
+  BT::NodeStatus tick(BT::TreeNode&)
+  {
+    return BT::NodeStatus::FAILURE;
+  }
+};
+
+using Branch = BT::Static::Fallback<Failure, BT::Static::Inverter<Failure>, Success>;
+using StaticRoot = BT::Static::Sequence<Branch, Branch, Branch, Branch, Branch>;
+}  // namespace
+
+static void BM_TickStaticTree(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<BT::StaticTree<StaticRoot>>("StaticRoot");
+  auto tree = factory.createTreeFromText(R"(<root BTCPP_format="4">
+    <BehaviorTree ID="Main"><StaticRoot/></BehaviorTree></root>)");
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickOnce());
+  }
+}
+BENCHMARK(BM_TickStaticTree);
+
+static void BM_TickDynamicTree(benchmark::State& state)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="Main"><Sequence>)";
+  for(int i = 0; i < 5; i++)
+  {
+    xml += "<Fallback><AlwaysFailure/><Inverter><AlwaysFailure/></Inverter>"
+           "<AlwaysSuccess/></Fallback>";
+  }
+  xml += "</Sequence></BehaviorTree></root>";
+
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickOnce());
+  }
+}
+BENCHMARK(BM_TickDynamicTree);
+
+// A reactive control with 100 children and a RUNNING one: at each tick,
+// all the other children are halted
+static void BM_TickWideReactiveFallback(benchmark::State& state)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="Main"><ReactiveFallback>
+    <KeepRunningUntilFailure><AlwaysSuccess/></KeepRunningUntilFailure>)";
+  for(int i = 0; i < 100; i++)
+  {
+    xml += "<AlwaysFailure/>";
+  }
+  xml += "</ReactiveFallback></BehaviorTree></root>";
+
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickExactlyOnce());
+  }
+}
+BENCHMARK(BM_TickWideReactiveFallback);
+
+// A reactive sequence with 20 guard conditions that read entries that don't
+// change (an array of 100 samples): evaluated at each tick, or memoized
+static void TickReactiveGuards(benchmark::State& state, const char* attributes)
+{
+  std::string xml =
+      R"(<root BTCPP_format="4"><BehaviorTree ID="Main"><ReactiveSequence>)";
+  for(int i = 0; i < 20; i++)
+  {
+    xml += R"(<ScriptCondition code="sum(samples) > 0 && b < 100" )";
+    xml += attributes;
+    xml += "/>";
+  }
+  xml += R"(<KeepRunningUntilFailure><AlwaysSuccess/></KeepRunningUntilFailure>
+            </ReactiveSequence></BehaviorTree></root>)";
+
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml);
+  tree.rootBlackboard()->set("samples", std::vector<double>(100, 1.0));
+  tree.rootBlackboard()->set("b", 1);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickExactlyOnce());
+  }
+}
+
+static void BM_TickReactiveGuards(benchmark::State& state)
+{
+  TickReactiveGuards(state, "");
+}
+BENCHMARK(BM_TickReactiveGuards);
+
+static void BM_TickMemoizedReactiveGuards(benchmark::State& state)
+{
+  TickReactiveGuards(state, R"(_memoize="true")");
+}
+BENCHMARK(BM_TickMemoizedReactiveGuards);
+
+// A tree waiting for a long Sleep, ticked periodically: every time or only
+// when something changed
+static void TickIdleTree(benchmark::State& state, bool if_needed)
+{
+  std::string xml =
+      R"(<root BTCPP_format="4"><BehaviorTree ID="Main"><ReactiveSequence>)";
+  for(int i = 0; i < 20; i++)
+  {
+    xml += R"(<ScriptCondition code="b < 100"/>)";
+  }
+  xml += R"(<Sleep msec="1000000"/></ReactiveSequence></BehaviorTree></root>)";
+
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml);
+  tree.rootBlackboard()->set("b", 1);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(if_needed ? tree.tickOnceIfNeeded() : tree.tickOnce());
+  }
+}
+
+static void BM_TickIdleTree(benchmark::State& state)
+{
+  TickIdleTree(state, false);
+}
+BENCHMARK(BM_TickIdleTree);
+
+static void BM_TickIdleTreeIfNeeded(benchmark::State& state)
+{
+  TickIdleTree(state, true);
+}
+BENCHMARK(BM_TickIdleTreeIfNeeded);
+
+// A fast monitor and an expensive branch: ticked at each tick of the tree,
+// or at most once per second
+static void TickMultiRate(benchmark::State& state, const char* attributes)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="Main"><ReactiveSequence>
+    <ScriptCondition code="b < 100"/><ReactiveSequence )";
+  xml += attributes;
+  xml += ">";
+  for(int i = 0; i < 20; i++)
+  {
+    xml += R"(<ScriptCondition code="sum(samples) > 0"/>)";
+  }
+  xml += R"(<KeepRunningUntilFailure><AlwaysSuccess/></KeepRunningUntilFailure>
+            </ReactiveSequence></ReactiveSequence></BehaviorTree></root>)";
+
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml);
+  tree.rootBlackboard()->set("samples", std::vector<double>(100, 1.0));
+  tree.rootBlackboard()->set("b", 1);
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickExactlyOnce());
+  }
+}
+
+static void BM_TickSingleRate(benchmark::State& state)
+{
+  TickMultiRate(state, "");
+}
+BENCHMARK(BM_TickSingleRate);
+
+static void BM_TickMultiRate(benchmark::State& state)
+{
+  TickMultiRate(state, R"(_period="1s")");
+}
+BENCHMARK(BM_TickMultiRate);
@@ -0,0 +1,348 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/bt_factory.h"
+
+// Creation of a tree with subtrees: parsing the XML every time (createTree)
+// or instantiating a TreeTemplate compiled once.
+
+static const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" counter:=0 " />
+      <SubTree ID="Increment" value="{counter}" step="1" />
+      <SubTree ID="Increment" value="{counter}" step="2" />
+      <SubTree ID="Increment" value="{counter}" step="3" />
+      <SubTree ID="Increment" value="{counter}" step="4" />
+      <Fallback>
+        <ScriptCondition code=" counter == 10 " />
+        <AlwaysFailure/>
+      </Fallback>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Sequence>
+      <Script code=" value += step " />
+      <Inverter>
+        <AlwaysFailure/>
+      </Inverter>
+      <SetBlackboard value="1" output_key="done" />
+    </Sequence>
+  </BehaviorTree>
+</root>)";
+
+static void BM_CreateTree(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  for(auto _ : state)
+  {
+    auto tree = factory.createTree("MainTree");
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_CreateTree);
+
+static void BM_InstantiateTreeTemplate(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto tree_template = factory.compileTree("MainTree");
+  for(auto _ : state)
+  {
+    auto tree = tree_template->instantiate();
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_InstantiateTreeTemplate);
+
+// Many threads creating trees from the same (immutable) TreeRegistry
+static void BM_CreateTreeFromRegistry(benchmark::State& state)
+{
+  static BT::TreeRegistry::Ptr registry;
+  if(state.thread_index() == 0)
+  {
+    BT::BehaviorTreeFactory factory;
+    factory.registerBehaviorTreeFromText(xml_text);
+    registry = factory.compileRegistry();
+  }
+  for(auto _ : state)
+  {
+    auto tree = registry->createTree("MainTree");
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_CreateTreeFromRegistry)->ThreadRange(1, 8)->UseRealTime();
+
+// Cold start: from the text of the XML or from the compiled tree
+static void BM_ColdStartFromXML(benchmark::State& state)
+{
+  for(auto _ : state)
+  {
+    BT::BehaviorTreeFactory factory;
+    factory.registerBehaviorTreeFromText(xml_text);
+    auto tree = factory.createTree("MainTree");
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_ColdStartFromXML);
+
+static void BM_ColdStartFromCompiledTree(benchmark::State& state)
+{
+  std::string buffer;
+  {
+    BT::BehaviorTreeFactory factory;
+    factory.registerBehaviorTreeFromText(xml_text);
+    buffer = factory.compileTree("MainTree")->serialize();
+  }
+  for(auto _ : state)
+  {
+    BT::BehaviorTreeFactory factory;
+    auto tree_template =
+        BT::TreeTemplate::deserialize(factory, buffer.data(), buffer.size());
+    auto tree = tree_template->instantiate();
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_ColdStartFromCompiledTree);
+
+// Startup of a tree with many contingency subtrees that are never ticked,
+// created eagerly or with the attribute _lazy
+static std::string ContingenciesXML(bool lazy)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree"><Sequence>)";
+  for(int i = 0; i < 50; i++)
+  {
+    xml += R"(<Fallback><AlwaysSuccess/><SubTree ID="Contingency" value="{counter}")";
+    xml += lazy ? R"( _lazy="true"/></Fallback>)" : "/></Fallback>";
+  }
+  xml += R"(</Sequence></BehaviorTree>
+  <BehaviorTree ID="Contingency">
+    <Sequence>
+      <Script code=" value += 1 " />
+      <Inverter><AlwaysFailure/></Inverter>
+      <Fallback>
+        <ScriptCondition code=" value &gt; 10 " />
+        <SetBlackboard value="1" output_key="done" />
+      </Fallback>
+      <Delay delay_msec="100"><AlwaysSuccess/></Delay>
+    </Sequence>
+  </BehaviorTree></root>)";
+  return xml;
+}
+
+static void CreateContingencies(benchmark::State& state, bool lazy)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(ContingenciesXML(lazy));
+  size_t nodes = 0;
+  for(auto _ : state)
+  {
+    auto tree = factory.createTree("MainTree");
+    nodes = 0;
+    tree.applyVisitor([&](const BT::TreeNode*) { nodes++; });
+  }
+  state.counters["nodes"] = double(nodes);
+}
+
+static void BM_CreateTreeEagerSubtrees(benchmark::State& state)
+{
+  CreateContingencies(state, false);
+}
+BENCHMARK(BM_CreateTreeEagerSubtrees);
+
+static void BM_CreateTreeLazySubtrees(benchmark::State& state)
+{
+  CreateContingencies(state, true);
+}
+BENCHMARK(BM_CreateTreeLazySubtrees);
+
+// Hot reload of the definition of one SubTree, in a tree with 50 of them
+static std::string ReloadableXML()
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree"><Sequence>)";
+  for(int i = 0; i < 50; i++)
+  {
+    xml += R"(<SubTree ID="Worker" name="worker_)" + std::to_string(i) + R"("/>)";
+  }
+  xml += R"(<SubTree ID="Special" name="special"/></Sequence></BehaviorTree>
+  <BehaviorTree ID="Worker">
+    <Sequence>
+      <Script code=" value:=1 " />
+      <Inverter><AlwaysFailure/></Inverter>
+      <ScriptCondition code=" value == 1 " />
+    </Sequence>
+  </BehaviorTree>)";
+  return xml;
+}
+
+static std::string SpecialXML(int value)
+{
+  return R"(<root BTCPP_format="4"><BehaviorTree ID="Special"><Sequence>
+    <Script code=" value:=)" +
+         std::to_string(value) + R"( " /><AlwaysSuccess/>
+    </Sequence></BehaviorTree></root>)";
+}
+
+static void BM_RebuildTree(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(ReloadableXML() + "</root>");
+  int value = 0;
+  for(auto _ : state)
+  {
+    factory.registerBehaviorTreeFromText(SpecialXML(value++));
+    auto tree = factory.createTree("MainTree");
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_RebuildTree);
+
+static void BM_ReloadTree(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(ReloadableXML() + "</root>");
+  factory.registerBehaviorTreeFromText(SpecialXML(0));
+  auto tree = factory.createTree("MainTree");
+  int value = 1;
+  for(auto _ : state)
+  {
+    auto rebuilt = factory.reloadTree(tree, SpecialXML(value++));
+    benchmark::DoNotOptimize(rebuilt);
+  }
+}
+BENCHMARK(BM_ReloadTree);
+
+// Creation of a tree with 200 nodes and 2000 substitution rules, most of them
+// matching none of the nodes (exact paths, prefixes and other wildcards)
+static void BM_CreateTreeWithSubstitutionRules(benchmark::State& state)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree"><Sequence>)";
+  for(int i = 0; i < 200; i++)
+  {
+    xml += R"(<AlwaysSuccess name="action_)" + std::to_string(i) + R"("/>)";
+  }
+  xml += "</Sequence></BehaviorTree></root>";
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml);
+  for(int i = 0; i < 2000; i++)
+  {
+    const auto suffix = std::to_string(i);
+    switch(i % 4)
+    {
+      case 0:
+        factory.addSubstitutionRule("mission/action_" + suffix, "AlwaysFailure");
+        break;
+      case 1:
+        factory.addSubstitutionRule("mission/step_" + suffix + "*", "AlwaysFailure");
+        break;
+      case 2:
+        factory.addSubstitutionRule("action_" + suffix + "_?", "AlwaysFailure");
+        break;
+      default:
+        factory.addSubstitutionRule("sensor_" + suffix, "AlwaysFailure");
+    }
+  }
+  for(auto _ : state)
+  {
+    auto tree = factory.createTree("MainTree");
+    benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_CreateTreeWithSubstitutionRules);
+
+// Lookup of nodes by path, in a tree with 100 SubTrees and 2100 nodes:
+// visiting all the nodes or using the index of the Tree
+static BT::Tree CreateLargeTree(BT::BehaviorTreeFactory& factory)
+{
+  std::string xml = R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree"><Sequence>)";
+  for(int i = 0; i < 100; i++)
+  {
+    xml += R"(<SubTree ID="Arm" name="arm_)" + std::to_string(i) + R"("/>)";
+  }
+  xml += R"(</Sequence></BehaviorTree><BehaviorTree ID="Arm"><Sequence>)";
+  for(int i = 0; i < 20; i++)
+  {
+    xml += R"(<AlwaysSuccess name="joint_)" + std::to_string(i) + R"("/>)";
+  }
+  xml += "</Sequence></BehaviorTree></root>";
+  factory.registerBehaviorTreeFromText(xml);
+  return factory.createTree("MainTree");
+}
+
+static void BM_ScanNodesByPath(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  auto tree = CreateLargeTree(factory);
+  for(auto _ : state)
+  {
+    std::vector<const BT::TreeNode*> nodes;
+    for(const auto& subtree : tree.subtrees)
+    {
+      for(const auto& node : subtree->nodes)
+      {
+        if(BT::WildcardMatch(node->fullPath(), "arm_42/*"))
+        {
+          nodes.push_back(node.get());
+        }
+      }
+    }
+    benchmark::DoNotOptimize(nodes);
+  }
+}
+BENCHMARK(BM_ScanNodesByPath);
+
+static void BM_GetNodesByPath(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  auto tree = CreateLargeTree(factory);
+  for(auto _ : state)
+  {
+    auto nodes = tree.getNodesByPath("arm_42/*");
+    benchmark::DoNotOptimize(nodes);
+  }
+}
+BENCHMARK(BM_GetNodesByPath);
+
+// Whole-tree operations on the same tree: visit from the root, visit the
+// list of nodes cached by the Tree and status snapshot.
+static void BM_VisitTreeRecursively(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  auto tree = CreateLargeTree(factory);
+  for(auto _ : state)
+  {
+    size_t count = 0;
+    BT::applyRecursiveVisitor(tree.rootNode(), [&count](BT::TreeNode*) { count++; });
+    benchmark::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_VisitTreeRecursively);
+
+static void BM_VisitTree(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  auto tree = CreateLargeTree(factory);
+  for(auto _ : state)
+  {
+    size_t count = 0;
+    tree.applyVisitor([&count](BT::TreeNode*) { count++; });
+    benchmark::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_VisitTree);
+
+static void BM_StatusSnapshot(benchmark::State& state)
+{
+  BT::BehaviorTreeFactory factory;
+  auto tree = CreateLargeTree(factory);
+  BT::SerializedTreeStatus snapshot;
+  for(auto _ : state)
+  {
+    BT::buildSerializedStatusSnapshot(tree.rootNode(), snapshot);
+    benchmark::DoNotOptimize(snapshot);
+  }
+}
+BENCHMARK(BM_StatusSnapshot);
@@ -118,7 +118,10 @@ class ThreadedAction : public ActionNodeBase
 public:
   ThreadedAction(const std::string& name, const NodeConfig& config)
     : ActionNodeBase(name, config)
-  {}
+  {
+    // the thread emits the wake-up signal when completed
+    setWaitForEvents(true);
+  }
 
   bool isHaltRequested() const
   {
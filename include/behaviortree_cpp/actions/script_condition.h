@@ -38,10 +38,31 @@ public:
                                "true") };
   }
 
+  std::vector<std::string> blackboardDependencies() const override
+  {
+    if(!_static_script)
+    {
+      throw RuntimeError("ScriptCondition [", name(),
+                         "]: a script read from the blackboard can't be memoized");
+    }
+    auto keys = ConditionNode::blackboardDependencies();
+    auto variables = ScriptDependencies(_script);
+    if(!variables)
+    {
+      throw RuntimeError(variables.error());
+    }
+    keys.insert(keys.end(), variables->begin(), variables->end());
+    return keys;
+  }
+
 private:
   virtual BT::NodeStatus tick() override
   {
-    loadExecutor();
+    // parse again only a script read from the blackboard, see isStaticInput()
+    if(!_static_script)
+    {
+      loadExecutor();
+    }
 
     Ast::Environment env = { config().blackboard, config().enums };
     auto result = _executor(env);
@@ -55,6 +76,8 @@ private:
     {
       throw RuntimeError("Missing port [code] in ScriptCondition");
     }
+    _static_script = isStaticInput("code");
+    // the same script, or an empty one: nothing to parse
     if(script == _script)
     {
       return;
@@ -73,6 +96,7 @@ private:
 
   std::string _script;
   ScriptFunction _executor;
+  bool _static_script = false;
 };
 
 }  // namespace BT
@@ -37,7 +37,11 @@ public:
 private:
   virtual BT::NodeStatus tick() override
   {
-    loadExecutor();
+    // parse again only a script read from the blackboard, see isStaticInput()
+    if(!_static_script)
+    {
+      loadExecutor();
+    }
     if(_executor)
     {
       Ast::Environment env = { config().blackboard, config().enums };
@@ -53,6 +57,8 @@ private:
     {
       throw RuntimeError("Missing port [code] in Script");
     }
+    _static_script = isStaticInput("code");
+    // the same script, or an empty one: nothing to parse
     if(script == _script)
     {
       return;
@@ -71,6 +77,7 @@ private:
 
   std::string _script;
   ScriptFunction _executor;
+  bool _static_script = false;
 };
 
 }  // namespace BT
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <functional>
 #include <string_view>
@@ -301,6 +302,29 @@ std::ostream& operator<<(std::ostream& os, const BT::PortDirection& type);
 [[nodiscard]] std::vector<StringView> splitString(const StringView& strToSplit,
                                                   char delimeter);
 
+// Number of parts that splitString() would return, without creating them.
+[[nodiscard]] size_t splitStringCount(const StringView& strToSplit, char delimeter);
+
+// Invoke func(StringView) on each of the parts that splitString() would return,
+// without allocating any memory.
+template <typename Func>
+inline void forEachSplit(const StringView& strToSplit, char delimeter, Func&& func)
+{
+  const char* pos = strToSplit.data();
+  const char* const end = pos + strToSplit.size();
+  while(pos < end)
+  {
+    // memchr is vectorized by all the major C libraries
+    auto next = static_cast<const char*>(std::memchr(pos, delimeter, size_t(end - pos)));
+    if(next == nullptr)
+    {
+      next = end;
+    }
+    func(StringView(pos, size_t(next - pos)));
+    pos = next + 1;
+  }
+}
+
 template <typename Predicate>
 using enable_if = typename std::enable_if<Predicate::value>::type*;
 
@@ -4,6 +4,7 @@
 #include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <atomic>
 
 #include "behaviortree_cpp/basic_types.h"
 #include "behaviortree_cpp/contrib/json.hpp"
@@ -51,10 +52,31 @@ public:
     // timestamp since epoch
     std::chrono::nanoseconds stamp = std::chrono::nanoseconds{ 0 };
 
+    // Back buffer written by asynchronous producers, when the entry
+    // is in "mailbox" mode. See Blackboard::enableMailbox()
+    // The latest value is swapped in and out atomically: no lock is needed.
+    struct Mailbox
+    {
+      std::atomic<Any*> pending = nullptr;
+
+      Mailbox() = default;
+      Mailbox(const Mailbox&) = delete;
+      Mailbox& operator=(const Mailbox&) = delete;
+      ~Mailbox()
+      {
+        delete pending.load();
+      }
+    };
+    std::unique_ptr<Mailbox> mailbox;
+
     Entry(const TypeInfo& _info) : info(_info)
     {}
 
     Entry& operator=(const Entry& other);
+
+    /// Call it after writing the value: it increments sequence_id and
+    /// Blackboard::writeVersion() and updates the stamp.
+    void markUpdated();
   };
 
   /** Use this static method to create an instance of the BlackBoard
@@ -65,10 +87,28 @@ public:
     return std::shared_ptr<Blackboard>(new Blackboard(parent));
   }
 
-  virtual ~Blackboard() = default;
+  virtual ~Blackboard();
 
   void enableAutoRemapping(bool remapping);
 
+  /**
+   * @brief structureVersion is a global counter, incremented every time an entry
+   * is added or removed, a remapping changes or a blackboard is destroyed,
+   * in any instance of Blackboard.
+   *
+   * Who caches the result of getEntry() can use it to know when the cache
+   * must be refreshed. It does NOT change when the value of an entry is updated.
+   */
+  [[nodiscard]] static uint64_t structureVersion();
+
+  /**
+   * @brief writeVersion is a global counter, incremented every time the value
+   * of an entry is written or posted to its mailbox, in any instance of Blackboard.
+   *
+   * If neither writeVersion() nor structureVersion() changed, no blackboard did.
+   */
+  [[nodiscard]] static uint64_t writeVersion();
+
   [[nodiscard]] const std::shared_ptr<Entry> getEntry(const std::string& key) const;
 
   [[nodiscard]] std::shared_ptr<Blackboard::Entry> getEntry(const std::string& key);
@@ -106,6 +146,33 @@ public:
 
   void unset(const std::string& key);
 
+  /**
+   * @brief enableMailbox switches an existing entry to the double-buffered
+   * (mailbox) mode.
+   *
+   * Threads outside the tree should then use post() instead of set():
+   * the value is written into a back buffer and it becomes visible only when
+   * commitMailboxes() is called. Tree does that once, at the beginning of each
+   * tickOnce(), therefore the value is stable for the entire tick.
+   *
+   * post() and commitMailboxes() exchange the posted value with an atomic
+   * pointer swap: producers never wait for each other or for the tick thread,
+   * and the tick thread never waits for the producers.
+   */
+  void enableMailbox(const std::string& key);
+
+  /// Write a value into the back buffer of an entry in mailbox mode.
+  /// If multiple values are posted between two commits, only the latest one is kept.
+  template <typename T>
+  void post(const std::string& key, const T& value);
+
+  /**
+   * @brief commitMailboxes moves the latest posted values into the entries.
+   *
+   * @return number of entries updated.
+   */
+  size_t commitMailboxes();
+
   [[nodiscard]] const TypeInfo* entryInfo(const std::string& key);
 
   void addSubtreeRemapping(StringView internal, StringView external);
@@ -149,6 +216,14 @@ private:
 
   std::shared_ptr<Entry> createEntryImpl(const std::string& key, const TypeInfo& info);
 
+  static void bumpStructureVersion();
+
+  void postImpl(const std::string& key, Entry& entry, Any&& value);
+
+  // entries in mailbox mode. Stored only in the root blackboard
+  std::vector<std::shared_ptr<Entry>> mailbox_entries_;
+  std::mutex mailbox_mutex_;
+
   bool autoremapping_ = false;
 };
 
@@ -197,6 +272,7 @@ inline void Blackboard::unset(const std::string& key)
   }
 
   storage_.erase(it);
+  bumpStructureVersion();
 }
 
 template <typename T>
@@ -231,8 +307,7 @@ inline void Blackboard::set(const std::string& key, const T& value)
     lock.lock();
 
     entry->value = new_value;
-    entry->sequence_id++;
-    entry->stamp = std::chrono::steady_clock::now().time_since_epoch();
+    entry->markUpdated();
   }
   else
   {
@@ -249,8 +324,7 @@ inline void Blackboard::set(const std::string& key, const T& value)
     {
       // Use the new type to create a new entry that is strongly typed.
       entry.info = TypeInfo::Create<T>();
-      entry.sequence_id++;
-      entry.stamp = std::chrono::steady_clock::now().time_since_epoch();
+      entry.markUpdated();
       previous_any = std::move(new_value);
       return;
     }
@@ -304,9 +378,43 @@ inline void Blackboard::set(const std::string& key, const T& value)
       // copy only if the type is compatible
       new_value.copyInto(previous_any);
     }
-    entry.sequence_id++;
-    entry.stamp = std::chrono::steady_clock::now().time_since_epoch();
+    entry.markUpdated();
+  }
+}
+
+template <typename T>
+inline void Blackboard::post(const std::string& key, const T& value)
+{
+  auto entry = getEntry(key);
+  if(!entry)
+  {
+    throw RuntimeError("Blackboard::post() error. Missing key [", key, "]");
+  }
+  Any new_value(value);
+
+  // the type of the entry can not change, once it is strongly typed
+  const auto& info = entry->info;
+  if constexpr(!std::is_same_v<Any, T>)
+  {
+    if(info.isStronglyTyped() && info.type() != typeid(T) &&
+       info.type() != new_value.type())
+    {
+      bool mismatching = true;
+      if constexpr(std::is_arithmetic_v<T>)
+      {
+        mismatching = !isCastingSafe(info.type(), value);
+      }
+      if(mismatching)
+      {
+        throw LogicError(StrCat("Blackboard::post(", key,
+                                "): once declared, the type of a port shall not "
+                                "change. Previously declared type [",
+                                BT::demangle(info.type()), "], current type [",
+                                BT::demangle(typeid(T)), "]"));
+      }
+    }
   }
+  postImpl(key, *entry, std::move(new_value));
 }
 
 template <typename T>
@@ -23,6 +23,7 @@
 
 #include "behaviortree_cpp/contrib/magic_enum.hpp"
 #include "behaviortree_cpp/behavior_tree.h"
+#include "behaviortree_cpp/utils/tick_statistics.h"
 
 namespace BT
 {
@@ -84,6 +85,36 @@ constexpr const char* PLUGIN_SYMBOL = "BT_RegisterNodesFromPlugin";
 
 bool WildcardMatch(const std::string& str, StringView filter);
 
+/// What Tree::tickAtFixedRate() does when a tick exceeds its budget.
+/// In any case, the periods that were missed are skipped: the following
+/// tick starts at the next deadline, and the count is in
+/// TickStatistics::missedDeadlineCount(), not in the jitter.
+enum class OverrunPolicy
+{
+  SKIP,         // nothing else
+  WARN,         // print a warning on std::cerr
+  USE_CALLBACK  // call FixedRateOptions::on_overrun
+};
+
+struct TickOverrun
+{
+  std::chrono::microseconds duration;
+  std::chrono::microseconds budget;
+  // number of periods that were skipped
+  uint64_t missed_deadlines = 0;
+};
+
+struct FixedRateOptions
+{
+  std::chrono::microseconds period = std::chrono::milliseconds(10);
+  // a tick longer than this is an overrun. If zero, the budget is the period
+  std::chrono::microseconds budget = std::chrono::microseconds(0);
+  OverrunPolicy overrun_policy = OverrunPolicy::WARN;
+  std::function<void(const TickOverrun&)> on_overrun;
+  // number of ticks used to compute TickStatistics::durationPercentile()
+  size_t statistics_window = 1000;
+};
+
 /**
  * @brief Struct used to store a tree.
  * If this object goes out of scope, the tree is destroyed.
@@ -109,11 +140,15 @@ public:
   Tree(const Tree&) = delete;
   Tree& operator=(const Tree&) = delete;
 
-  Tree(Tree&& other) = default;
-  Tree& operator=(Tree&& other) = default;
+  Tree(Tree&& other);
+  Tree& operator=(Tree&& other);
 
   void initialize();
 
+  /// Create now the nodes of all the lazy SubTrees (attribute "_lazy"),
+  /// including the nested ones, instead of waiting for their first tick.
+  void instantiateLazySubtrees();
+
   void haltTree();
 
   [[nodiscard]] TreeNode* rootNode() const;
@@ -140,12 +175,48 @@ public:
    */
   NodeStatus tickOnce();
 
+  /**
+   * @brief Same as tickOnce(), but the tick is skipped if the tree is RUNNING and
+   * nothing that could change its status happened since the previous tick.
+   *
+   * The tick is skipped (and RUNNING returned) only if:
+   *
+   * - all the nodes that returned RUNNING waitsForEvents(), i.e. they will
+   *   call emitWakeUpSignal() when they need to be ticked;
+   * - no signal was emitted, no blackboard was written and no entry was
+   *   added or removed;
+   * - markDirty() was not called;
+   * - no node with the attribute _period must be ticked yet.
+   *
+   * Use markDirty() if the tree depends on something else, for instance
+   * a condition reading a sensor directly.
+   */
+  NodeStatus tickOnceIfNeeded();
+
+  /// The next call of tickOnceIfNeeded() will tick the tree. Thread-safe.
+  void markDirty();
+
   /// Call tickOnce until the status is different from RUNNING.
   /// Note that between one tick and the following one,
-  /// a Tree::sleep() is used
+  /// a Tree::sleep() is used, shorter than sleep_time if a node with
+  /// the attribute _period (for instance _period="1ms") must be ticked earlier.
   NodeStatus
   tickWhileRunning(std::chrono::milliseconds sleep_time = std::chrono::milliseconds(10));
 
+  /**
+   * @brief Call tickOnce() until the status is different from RUNNING, at a
+   * fixed rate: the ticks start at absolute deadlines, one period apart,
+   * therefore the period doesn't depend on the duration of the tick.
+   *
+   * The signal of emitWakeUpSignal() is handled by tickOnce(), but it doesn't
+   * anticipate the next deadline. The timing is stored in tickStatistics(),
+   * that is reset at the beginning.
+   */
+  NodeStatus tickAtFixedRate(const FixedRateOptions& options);
+
+  /// The statistics of the last call of tickAtFixedRate().
+  [[nodiscard]] const TickStatistics& tickStatistics() const;
+
   [[nodiscard]] Blackboard::Ptr rootBlackboard();
 
   //Call the visitor for each node of the tree.
@@ -154,6 +225,10 @@ public:
   //Call the visitor for each node of the tree.
   void applyVisitor(const std::function<void(TreeNode*)>& visitor);
 
+  /// All the nodes of the tree, in the order used by applyVisitor() (pre-order).
+  /// The list is built by initialize() and updated when a lazy SubTree is created.
+  [[nodiscard]] const std::vector<TreeNode*>& preOrderNodes() const;
+
   [[nodiscard]] uint16_t getUID();
 
   /// Get a list of nodes which fullPath() match a wildcard filter and
@@ -166,22 +241,37 @@ public:
   getNodesByPath(StringView wildcard_filter) const
   {
     std::vector<const TreeNode*> nodes;
-    for(auto const& subtree : subtrees)
+    for(const TreeNode* node : findNodesByPath(wildcard_filter))
     {
-      for(auto const& node : subtree->nodes)
+      if constexpr(std::is_same_v<NodeType, TreeNode>)
+      {
+        nodes.push_back(node);
+      }
+      else if(dynamic_cast<const NodeType*>(node))
       {
-        if(auto node_recast = dynamic_cast<const NodeType*>(node.get()))
-        {
-          if(WildcardMatch(node->fullPath(), wildcard_filter))
-          {
-            nodes.push_back(node.get());
-          }
-        }
+        nodes.push_back(node);
       }
     }
     return nodes;
   }
 
+  /**
+   * @brief findNodesByPath returns the nodes which fullPath() match a wildcard
+   * filter, in the same order of Tree::subtrees.
+   *
+   * It uses an index of the paths, built by initialize(): only the nodes
+   * that start with the characters that precede the first wildcard of
+   * the filter are visited.
+   */
+  [[nodiscard]] std::vector<TreeNode*> findNodesByPath(StringView wildcard_filter) const;
+
+  /// The node with this fullPath(), or nullptr. If more nodes have the same
+  /// path, the first one in the order of Tree::subtrees.
+  [[nodiscard]] TreeNode* getNodeByPath(StringView path) const;
+
+  /// The node with this UID, or nullptr.
+  [[nodiscard]] TreeNode* getNodeByUID(uint16_t uid) const;
+
 private:
   std::shared_ptr<WakeUpSignal> wake_up_;
 
@@ -194,10 +284,147 @@ private:
 
   NodeStatus tickRoot(TickOption opt, std::chrono::milliseconds sleep_time);
 
+  // what tickOnceIfNeeded() compares with the previous tick
+  struct ChangeSources
+  {
+    uint64_t write_version = 0;
+    uint64_t structure_version = 0;
+    uint64_t wake_up_count = 0;
+
+    bool operator==(const ChangeSources& other) const
+    {
+      return write_version == other.write_version &&
+             structure_version == other.structure_version &&
+             wake_up_count == other.wake_up_count;
+    }
+  };
+  ChangeSources last_sources_;
+  std::atomic_bool dirty_ = true;
+
+  TickStatistics tick_statistics_;
+
+  // to be called right before the root is ticked
+  void recordChangeSources();
+
   uint16_t uid_counter_ = 0;
+
+  friend class SubTreeNode;
+  // lazy SubTrees, whose nodes were not created yet
+  std::vector<SubTreeNode*> lazy_subtrees_;
+
+  void bindLazySubtree(TreeNode& node);
+  void addLazySubtrees(SubTreeNode& node, std::vector<Subtree::Ptr> new_subtrees);
+
+  // index of the nodes, built by initialize()
+  struct PathEntry
+  {
+    StringView path;
+    TreeNode* node;
+    // position in Tree::subtrees
+    size_t order;
+  };
+  // sorted by path
+  std::vector<PathEntry> nodes_by_path_;
+  std::vector<TreeNode*> nodes_by_uid_;
+  size_t indexed_nodes_ = 0;
+
+  void addToNodeIndex(const std::vector<Subtree::Ptr>& new_subtrees);
+
+  std::vector<TreeNode*> preorder_nodes_;
+  void updatePreOrderNodes();
+};
+
+class BehaviorTreeFactory;
+
+/**
+ * @brief TreeTemplate is a tree that was compiled once (see
+ * BehaviorTreeFactory::compileTree) and can be instantiated many times.
+ *
+ * The XML is parsed and validated only once: the template stores the
+ * sequence of operations needed to create the blackboards and the nodes,
+ * with their final configuration. Each call of instantiate() returns a new, independent
+ * Tree, equivalent to the one created by BehaviorTreeFactory::createTree().
+ *
+ * The template is immutable and instantiate() can be called concurrently,
+ * but not while the factory is modified: it refers to the factory that created
+ * it, that must outlive it. TreeRegistry doesn't have this limitation.
+ */
+class TreeTemplate
+{
+public:
+  using Ptr = std::shared_ptr<const TreeTemplate>;
+
+  ~TreeTemplate();
+
+  TreeTemplate(const TreeTemplate&) = delete;
+  TreeTemplate& operator=(const TreeTemplate&) = delete;
+
+  /// Create a new instance of the tree, using the given root blackboard.
+  /// Tree::manifests contains only the node types used by the tree.
+  [[nodiscard]] Tree instantiate(Blackboard::Ptr blackboard = Blackboard::create()) const;
+
+  /// ID of the main tree
+  [[nodiscard]] const std::string& treeID() const;
+
+  /// Number of nodes of each instance, including the ones in the subtrees.
+  [[nodiscard]] size_t nodesCount() const;
+
+  /// Version of the binary format written by serialize()
+  static constexpr uint32_t BINARY_FORMAT_VERSION = 1;
+
+  /**
+   * @brief serialize the template into a binary buffer, that can be saved
+   * and loaded later with deserialize(), without parsing the XML again.
+   *
+   * The buffer contains the IDs of the node types and the names of their
+   * ports, but not the node types themselves: they must be registered into
+   * the factory that loads it.
+   */
+  [[nodiscard]] std::string serialize() const;
+
+  /**
+   * @brief deserialize a buffer created by serialize().
+   *
+   * The buffer is not used after this function returns; it can be, for instance,
+   * a memory-mapped file.
+   * Throws RuntimeError if the buffer is not valid, if it was written with
+   * a different version of the format or if a node type is not registered.
+   */
+  [[nodiscard]] static Ptr deserialize(const BehaviorTreeFactory& factory,
+                                       const void* data, size_t size);
+
+  /**
+   * @brief generateCode creates the C++ code of a function that builds the tree
+   * directly, without the XML:
+   *
+   *   BT::Tree function_name(const BT::BehaviorTreeFactory& factory,
+   *                          BT::Blackboard::Ptr blackboard = BT::Blackboard::create());
+   *
+   * The generated function replays the steps of instantiate(): it saves the
+   * parsing of the XML, the validation and the lookup of the subtree models,
+   * but nothing else. The nodes are created with the builders of the factory,
+   * that must register the same node types, they are ticked through the usual
+   * virtual interface, the ports are remapped by name and the scripts are parsed
+   * and interpreted at run-time.
+   * For statically dispatched control flow, see static_tree.h.
+   */
+  [[nodiscard]] std::string generateCode(const std::string& function_name) const;
+
+private:
+  friend class XMLParser;
+  friend class BehaviorTreeFactory;
+
+  struct PImpl;
+  std::unique_ptr<PImpl> _p;
+
+  explicit TreeTemplate(const BehaviorTreeFactory& factory);
+
+  // copy of this template, that uses a different (but equivalent) factory
+  [[nodiscard]] Ptr rebind(const BehaviorTreeFactory& factory) const;
 };
 
 class Parser;
+class TreeRegistry;
 
 /**
  * @brief The BehaviorTreeFactory is used to create instances of a
@@ -276,6 +503,39 @@ public:
      */
   void registerFromPlugin(const std::string& file_path);
 
+  /**
+     * @brief registerFromPluginManifest registers the nodes of a plugin using a cache
+     * of their manifests, without loading the shared library. The library is loaded
+     * only when one of its nodes is needed to create a tree (see loadDeferredPlugin).
+     *
+     * The cache is the XML created by writePluginManifestXML(), for instance with the
+     * tool "bt4_plugin_manifest --xml". If it doesn't exist or it is older than
+     * the plugin, the plugin is loaded immediately and the cache is written again;
+     * if that fails, RuntimeError is thrown, after the registration of the nodes.
+     *
+     * The nodes and the scripting enums in the cache are registered immediately.
+     * The ports in manifests() have no type; once the plugin is loaded, findManifest()
+     * returns the manifests of the plugin.
+     * Loading the plugin throws RuntimeError if it registers substitution rules
+     * or trees, or scripting enums that are not in the cache.
+     *
+     * @param file_path      path of the plugin
+     * @param manifest_path  path of the cache
+     */
+  void registerFromPluginManifest(const std::string& file_path,
+                                  const std::filesystem::path& manifest_path);
+
+  /**
+     * @brief loadDeferredPlugin loads the plugin that contains a node registered with
+     * registerFromPluginManifest(), if it was not loaded yet. Called by the parser
+     * before creating a node, to know the types of its ports.
+     *
+     * The factory is not modified, therefore it can be called by multiple threads.
+     *
+     * @return true if the plugin was loaded by this call.
+     */
+  bool loadDeferredPlugin(const std::string& ID) const;
+
   /**
      * @brief registerFromROSPlugins finds all shared libraries that export ROS plugins for behaviortree_cpp, and calls registerFromPlugin for each library.
      * @throws If not compiled with ROS support or if the library cannot load for any reason
@@ -395,6 +655,11 @@ public:
   [[nodiscard]] const std::unordered_map<std::string, TreeNodeManifest>&
   manifests() const;
 
+  /// Manifest of a registered TreeNode, or nullptr. For the nodes of a deferred
+  /// plugin that was loaded, it is the manifest of the plugin, not the one in
+  /// manifests() (see registerFromPluginManifest).
+  [[nodiscard]] const TreeNodeManifest* findManifest(const std::string& ID) const;
+
   /// List of builtin IDs.
   [[nodiscard]] const std::set<std::string>& builtinNodes() const;
 
@@ -430,6 +695,64 @@ public:
   [[nodiscard]] Tree createTree(const std::string& tree_name,
                                 Blackboard::Ptr blackboard = Blackboard::create());
 
+  /**
+   * @brief compileTree parses and validates a tree registered with
+   * registerBehaviorTreeFromText() or registerBehaviorTreeFromFile() once.
+   * Use the returned template to create many instances of the same tree,
+   * faster than createTree().
+   *
+   * Manifests, builders and substitution rules are read from this factory
+   * when the template is instantiated.
+   *
+   * @param tree_name  the ID of the tree
+   */
+  [[nodiscard]] TreeTemplate::Ptr compileTree(const std::string& tree_name);
+
+  /**
+   * @brief loadCompiledTreeFromFile loads a tree saved with TreeTemplate::serialize(),
+   * for instance by the tool bt4_compile_tree.
+   * The nodes used by the tree must be registered into this factory.
+   */
+  [[nodiscard]] TreeTemplate::Ptr
+  loadCompiledTreeFromFile(const std::filesystem::path& file_path);
+
+  /**
+   * @brief reloadTree registers new definitions of some trees (same as
+   * registerBehaviorTreeFromText) and applies them to a tree that was created
+   * by this factory, without destroying it.
+   *
+   * The definitions that are not included in xml_text are not modified.
+   * Only the instances of the SubTrees whose definition changed are created
+   * again, together with the SubTrees they contain; the rest of the tree,
+   * including the nodes that are RUNNING, is not touched.
+   *
+   * - A rebuilt SubTree keeps its blackboard. The entries of the nested
+   *   SubTrees are copied into the new ones, if they have the same path
+   *   (i.e. if the SubTree has the attribute "name").
+   * - If a rebuilt SubTree was RUNNING, it is halted and will start from the
+   *   beginning.
+   * - The new nodes get new UIDs. Loggers created before the reload will not
+   *   observe them.
+   * - Lazy SubTrees that were not created yet keep the old definition.
+   *
+   * If an exception is thrown, the tree should be destroyed.
+   *
+   * @param tree      a tree created by this factory.
+   * @param xml_text  the new definition of one or more trees.
+   * @return the paths (Subtree::instance_name) of the SubTrees that were
+   * created again. The path of the main tree is an empty string.
+   */
+  std::vector<std::string> reloadTree(Tree& tree, const std::string& xml_text);
+
+  /**
+   * @brief compileRegistry compiles all the registered trees and returns an
+   * immutable snapshot of this factory (builders, manifests, scripting enums
+   * and substitution rules), that can be shared by many threads.
+   *
+   * Changes applied to the factory afterward are not visible in the registry.
+   */
+  [[nodiscard]] std::shared_ptr<const TreeRegistry> compileRegistry();
+
   /// Add metadata to a specific manifest. This metadata will be added
   /// to <TreeNodesModel> with the function writeTreeNodesModelXML()
   void addMetadataToManifest(const std::string& node_id, const KeyValueVector& metadata);
@@ -449,6 +772,9 @@ public:
    */
   void registerScriptingEnum(StringView name, int value);
 
+  /// The enums registered with registerScriptingEnum().
+  [[nodiscard]] const std::unordered_map<std::string, int>& scriptingEnums() const;
+
   /**
    * @brief registerScriptingEnums is syntactic sugar
    * to automatically register multiple enums. We use
@@ -480,7 +806,8 @@ public:
    * If the rule is a TestNodeConfig, a test node with that configuration will be created instead.
    *
    * @param filter   filter used to select the node to sobstitute. The node path is used.
-   *                 You may use wildcard matching.
+   *                 You may use wildcard matching. If more rules match the same node,
+   *                 the one added first is used.
    * @param rule     pass either a string or a TestNodeConfig
    */
   void addSubstitutionRule(StringView filter, SubstitutionRule rule);
@@ -503,6 +830,52 @@ public:
 private:
   struct PImpl;
   std::unique_ptr<PImpl> _p;
+
+  friend class XMLParser;
+
+  // Copy of what is needed to instantiate the nodes: builders, manifests,
+  // scripting enums (shared, not copied) and substitution rules.
+  [[nodiscard]] std::unique_ptr<BehaviorTreeFactory> cloneNodeTypes() const;
+};
+
+/**
+ * @brief TreeRegistry is created by BehaviorTreeFactory::compileRegistry()
+ * and contains all the trees of the factory, already compiled.
+ *
+ * It is immutable, therefore any number of threads can call createTree()
+ * concurrently, without locks. The builders of the nodes are invoked by those
+ * threads too: they must be thread-safe (the ones created by registerNodeType()
+ * are, unless the constructor of the node is not).
+ */
+class TreeRegistry
+{
+public:
+  using Ptr = std::shared_ptr<const TreeRegistry>;
+
+  ~TreeRegistry();
+
+  TreeRegistry(const TreeRegistry& other) = delete;
+  TreeRegistry& operator=(const TreeRegistry& other) = delete;
+
+  /// Create an instance of the tree. Throws if the ID is unknown or the
+  /// tree could not be compiled.
+  [[nodiscard]] Tree createTree(const std::string& tree_name,
+                                Blackboard::Ptr blackboard = Blackboard::create()) const;
+
+  [[nodiscard]] TreeTemplate::Ptr treeTemplate(const std::string& tree_name) const;
+
+  [[nodiscard]] std::vector<std::string> registeredBehaviorTrees() const;
+
+  /// The copy of the factory used to instantiate the nodes.
+  [[nodiscard]] const BehaviorTreeFactory& factory() const;
+
+private:
+  friend class BehaviorTreeFactory;
+
+  struct PImpl;
+  std::unique_ptr<PImpl> _p;
+
+  TreeRegistry();
 };
 
 /**
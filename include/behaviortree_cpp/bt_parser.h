@@ -47,6 +47,19 @@ public:
                                std::string tree_name = {}) = 0;
 
   virtual void clearInternalState(){};
+
+  /// See BehaviorTreeFactory::compileTree
+  virtual TreeTemplate::Ptr compileTree(const std::string& tree_name)
+  {
+    throw LogicError("This parser doesn't support compileTree(): ", tree_name);
+  }
+
+  /// See BehaviorTreeFactory::reloadTree
+  virtual std::vector<std::string> reloadTree(Tree& /*tree*/,
+                                              const std::string& /*xml_text*/)
+  {
+    throw LogicError("This parser doesn't support reloadTree()");
+  }
 };
 
 }  // namespace BT
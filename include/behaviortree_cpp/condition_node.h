@@ -35,6 +35,18 @@ public:
   {
     return NodeType::CONDITION;
   }
+
+  /**
+   * @brief Keys of the blackboard entries read by tick().
+   *
+   * If the node has the attribute _memoize="true", tick() is executed again
+   * only when one of these entries is updated; otherwise the previous result
+   * is returned. Changes made through Blackboard::getAnyLocked() are not detected.
+   *
+   * By default, the entries remapped to the input ports. Override it if
+   * tick() reads other entries.
+   */
+  virtual std::vector<std::string> blackboardDependencies() const;
 };
 
 /**
@@ -40,6 +40,15 @@
 // in order to disable functions working with the typeid of a type
 #endif
 
+// Size of the inline buffer, in words. Types that are nothrow move constructible
+// and fit into it are stored without any heap allocation.
+// BehaviorTree.CPP defines it through the CMake variable BTCPP_ANY_INLINE_WORDS;
+// this is the only default: 4 words are enough to store in-place std::string,
+// std::vector, std::shared_ptr and SafeAny::SimpleString.
+#ifndef ANY_IMPL_STACK_STORAGE_WORDS
+#   define ANY_IMPL_STACK_STORAGE_WORDS 4
+#endif
+
 
 namespace linb
 {
@@ -211,10 +220,10 @@ private: // Storage and Virtual Method Table
 
     union storage_union
     {
-        using stack_storage_t = typename std::aligned_storage<2 * sizeof(void*), std::alignment_of<void*>::value>::type;
+        using stack_storage_t = typename std::aligned_storage<ANY_IMPL_STACK_STORAGE_WORDS * sizeof(void*), std::alignment_of<void*>::value>::type;
 
         void*               dynamic;
-        stack_storage_t     stack;      // 2 words for e.g. shared_ptr
+        stack_storage_t     stack;      // at least 2 words for e.g. shared_ptr
     };
 
     /// Base VTable specification.
@@ -347,6 +356,8 @@ protected:
     friend const T* any_cast(const any* operand) noexcept;
     template<typename T>
     friend T* any_cast(any* operand) noexcept;
+    template<typename T>
+    friend const T* unchecked_any_cast(const any* operand) noexcept;
 
 #ifndef ANY_IMPL_NO_RTTI
     /// Same effect as is_same(this->type(), t);
@@ -536,6 +547,14 @@ inline ValueType* any_cast(any* operand) noexcept
         return nullptr;
 }
 
+/// Pointer to the object contained by operand, without any type check.
+/// The caller must know that operand is not empty and contains a ValueType.
+template<typename ValueType>
+inline const ValueType* unchecked_any_cast(const any* operand) noexcept
+{
+    return operand->cast<ValueType>();
+}
+
 inline void swap(any& lhs, any& rhs) noexcept
 {
     lhs.swap(rhs);
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include "behaviortree_cpp/tree_node.h"
 
@@ -23,6 +25,9 @@ class ControlNode : public TreeNode
 protected:
   std::vector<TreeNode*> children_nodes_;
 
+  // children() reads it directly
+  friend class TreeNode;
+
 public:
   ControlNode(const std::string& name, const NodeConfig& config);
 
@@ -48,8 +53,15 @@ public:
   [[deprecated("deprecated: please use explicitly haltChildren() or haltChild(i)")]] void
   haltChildren(size_t first);
 
+  /// Halt and reset the child i. Nothing to do if it is IDLE already.
   void haltChild(size_t i);
 
+  /// Halt and reset all the children that are not IDLE, except the child "index".
+  void haltOtherChildren(size_t index);
+
+  /// True if the status of the child i is not IDLE.
+  [[nodiscard]] bool isChildActive(size_t i) const;
+
   virtual NodeType type() const override final
   {
     return NodeType::CONTROL;
@@ -58,5 +70,16 @@ public:
   /// Set the status of all children to IDLE.
   /// also send a halt() signal to all RUNNING children
   void resetChildren();
+
+private:
+  // Bit i is set when the status of the child i is not IDLE. The children
+  // update it in setStatus() and resetStatus(), therefore halting or resetting
+  // the children visits only the active ones. Each child shares the ownership
+  // of its word, because it may be destroyed after this node.
+  std::shared_ptr<std::atomic<uint64_t>[]> active_children_;
+  size_t active_words_ = 0;
+
+  // Call haltChild() for each active child, but "skip_index"
+  void haltActiveChildren(size_t skip_index);
 };
 }  // namespace BT
@@ -10,6 +10,9 @@ class DecoratorNode : public TreeNode
 protected:
   TreeNode* child_node_;
 
+  // children() reads it directly
+  friend class TreeNode;
+
 public:
   DecoratorNode(const std::string& name, const NodeConfig& config);
 
@@ -40,7 +40,11 @@ public:
 private:
   virtual BT::NodeStatus tick() override
   {
-    loadExecutor();
+    // parse again only a script read from the blackboard, see isStaticInput()
+    if(!_static_script)
+    {
+      loadExecutor();
+    }
 
     BT::NodeStatus else_return;
     if(!getInput("else", else_return))
@@ -74,6 +78,8 @@ private:
     {
       throw RuntimeError("Missing parameter [if] in Precondition");
     }
+    _static_script = isStaticInput("if");
+    // the same script, or an empty one: nothing to parse
     if(script == _script)
     {
       return;
@@ -92,6 +98,7 @@ private:
 
   std::string _script;
   ScriptFunction _executor;
+  bool _static_script = false;
   bool _children_running = false;
 };
 
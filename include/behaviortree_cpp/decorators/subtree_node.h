@@ -1,10 +1,14 @@
 #ifndef DECORATOR_SUBTREE_NODE_H
 #define DECORATOR_SUBTREE_NODE_H
 
+#include <functional>
+
 #include "behaviortree_cpp/decorator_node.h"
 
 namespace BT
 {
+class Tree;
+
 /**
  * @brief The SubTreeNode is a way to wrap an entire Subtree,
  * creating a separated BlackBoard.
@@ -48,6 +52,16 @@ namespace BT
  * 3) Subtree: "{param}" -> Parent: "{parent}"
  *    Setting to true (or 1) the attribute "_autoremap", we are automatically remapping
  *    each port. Useful to avoid boilerplate.
+ *
+ * If the attribute "_lazy" is true, the nodes of the subtree are created
+ * only when the SubTree is ticked for the first time, or when
+ * instantiateSubtree() is called. They get the same UIDs and paths they would
+ * have if created with the rest of the tree, but their Tree::Subtree is
+ * appended at the end of Tree::subtrees. Loggers created before that
+ * will not observe them.
+ * They are created with a copy of the builders, manifests and substitution rules
+ * of the factory, taken when the tree is created: the factory can be modified
+ * or destroyed in the meantime.
  */
 class SubTreeNode : public DecoratorNode
 {
@@ -74,8 +88,33 @@ public:
     return NodeType::SUBTREE;
   }
 
+  /// Function that creates the nodes of a lazy subtree into a new Tree.
+  using LazyBuilder = std::function<void(SubTreeNode&, Tree&)>;
+
+  /// Used by the parser to delay the creation of the subtree (attribute "_lazy").
+  void setLazyBuilder(LazyBuilder builder)
+  {
+    lazy_builder_ = std::move(builder);
+  }
+
+  /// True if the subtree is lazy and its nodes were not created yet.
+  [[nodiscard]] bool isLazy() const
+  {
+    return bool(lazy_builder_);
+  }
+
+  /// Create the nodes of a lazy subtree now, instead of the first tick.
+  void instantiateSubtree();
+
 private:
+  friend class Tree;
+  // to replace the child, see BehaviorTreeFactory::reloadTree
+  friend class XMLParser;
+
   std::string subtree_id_;
+  LazyBuilder lazy_builder_;
+  // the tree that owns this node, set by Tree::initialize() if lazy
+  Tree* tree_ = nullptr;
 };
 
 }  // namespace BT
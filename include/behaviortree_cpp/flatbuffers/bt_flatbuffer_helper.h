@@ -65,18 +65,11 @@ inline void CreateFlatbuffersBehaviorTree(flatbuffers::FlatBufferBuilder& builde
   std::vector<flatbuffers::Offset<Serialization::TreeNode>> fb_nodes;
 
   applyRecursiveVisitor(tree.rootNode(), [&](BT::TreeNode* node) {
+    // the child of a lazy SubTree may not exist yet
     std::vector<uint16_t> children_uid;
-    if(auto control = dynamic_cast<BT::ControlNode*>(node))
+    children_uid.reserve(node->children().size());
+    for(const BT::TreeNode* child : node->children())
     {
-      children_uid.reserve(control->children().size());
-      for(const auto& child : control->children())
-      {
-        children_uid.push_back(child->UID());
-      }
-    }
-    else if(auto decorator = dynamic_cast<BT::DecoratorNode*>(node))
-    {
-      const auto& child = decorator->child();
       children_uid.push_back(child->UID());
     }
 
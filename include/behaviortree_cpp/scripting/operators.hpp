@@ -407,8 +407,9 @@ struct ExprComparison : ExprBase
       }
       else if(lhs_v.isString() && rhs_v.isString())
       {
-        auto lv = lhs_v.cast<SimpleString>();
-        auto rv = rhs_v.cast<SimpleString>();
+        // no copy: strings sharing the same buffer are compared by pointer
+        const auto& lv = *lhs_v.castPtr<SimpleString>();
+        const auto& rv = *rhs_v.castPtr<SimpleString>();
         if(!SwitchImpl(lv, rv, ops[i]))
         {
           return False;
@@ -469,6 +470,39 @@ struct ExprIf : ExprBase
   }
 };
 
+/**
+ * @brief Call of a built-in function.
+ *
+ * The functions operate on arrays stored in the blackboard (std::vector of
+ * double, float, int or int64_t, or a string like "1;2;3"); blackboard entries are
+ * read in-place, without copying them:
+ *
+ * - min(v), max(v), sum(v): reductions. min and max also accept two or more numbers.
+ * - dot(a, b): dot product of arrays with the same size.
+ * - any(v > x), all(v > x), count(v > x): the comparison is applied to each element
+ *   of the array (the number can be on either side; any comparison operator).
+ *
+ * The result is always a number; any and all return 1 or 0, like comparisons.
+ */
+struct ExprFunction : ExprBase
+{
+  enum func_t
+  {
+    min,
+    max,
+    sum,
+    dot,
+    any,
+    all,
+    count
+  } func;
+  std::vector<expr_ptr> args;
+
+  ExprFunction(const std::string& name, std::vector<expr_ptr> arguments);
+
+  Any evaluate(Environment& env) const override;
+};
+
 struct ExprAssignment : ExprBase
 {
   enum op_t
@@ -503,19 +537,31 @@ struct ExprAssignment : ExprBase
 
   expr_ptr lhs, rhs;
 
-  explicit ExprAssignment(expr_ptr _lhs, op_t op, expr_ptr _rhs)
-    : op(op), lhs(LEXY_MOV(_lhs)), rhs(LEXY_MOV(_rhs))
-  {}
-
-  Any evaluate(Environment& env) const override
+  const std::string& lhsName() const
   {
     auto varname = dynamic_cast<ExprName*>(lhs.get());
     if(!varname)
     {
       throw RuntimeError("Assignment left operand not a blackboard entry");
     }
-    const auto& key = varname->name;
+    return varname->name;
+  }
+
+  explicit ExprAssignment(expr_ptr _lhs, op_t op, expr_ptr _rhs)
+    : op(op), lhs(LEXY_MOV(_lhs)), rhs(LEXY_MOV(_rhs))
+  {}
 
+  Any evaluate(Environment& env) const override
+  {
+    auto entry = getOrCreateEntry(env);
+    return assign(env, *entry, rhs->evaluate(env));
+  }
+
+  // Find the entry on the left side of the assignment.
+  // It is created only by the operator :=
+  std::shared_ptr<Blackboard::Entry> getOrCreateEntry(Environment& env) const
+  {
+    const auto& key = lhsName();
     auto entry = env.vars->getEntry(key);
     if(!entry)
     {
@@ -540,10 +586,15 @@ struct ExprAssignment : ExprBase
         throw RuntimeError(msg);
       }
     }
-    auto value = rhs->evaluate(env);
+    return entry;
+  }
 
-    std::scoped_lock lock(entry->entry_mutex);
-    auto* dst_ptr = &entry->value;
+  // Assign the value of the right operand, already evaluated, to the entry
+  Any assign(Environment& env, Blackboard::Entry& entry, Any value) const
+  {
+    const auto& key = lhsName();
+    std::scoped_lock lock(entry.entry_mutex);
+    auto* dst_ptr = &entry.value;
 
     auto errorPrefix = [dst_ptr, &key]() {
       return StrCat("Error assigning a value to entry [", key, "] with type [",
@@ -559,7 +610,7 @@ struct ExprAssignment : ExprBase
     {
       // the very fist assignment can come from any type.
       // In the future, type check will be done by Any::copyInto
-      if(dst_ptr->empty() && entry->info.type() == typeid(AnyTypeAllowed))
+      if(dst_ptr->empty() && entry.info.type() == typeid(AnyTypeAllowed))
       {
         *dst_ptr = value;
       }
@@ -602,8 +653,7 @@ struct ExprAssignment : ExprBase
           throw RuntimeError(msg);
         }
       }
-      entry->sequence_id++;
-      entry->stamp = std::chrono::steady_clock::now().time_since_epoch();
+      entry.markUpdated();
       return *dst_ptr;
     }
 
@@ -658,8 +708,7 @@ struct ExprAssignment : ExprBase
     }
 
     temp_variable.copyInto(*dst_ptr);
-    entry->sequence_id++;
-    entry->stamp = std::chrono::steady_clock::now().time_since_epoch();
+    entry.markUpdated();
     return *dst_ptr;
   }
 };
@@ -683,6 +732,20 @@ struct nested_expr : lexy::transparent_production
   static constexpr auto value = lexy::forward<Ast::expr_ptr>;
 };
 
+// Call of a built-in function, for instance "max(values)" or "dot(a, b)"
+struct FunctionCall
+{
+  static constexpr auto rule =
+      dsl::p<Name> + dsl::parenthesized.list(dsl::p<nested_expr>, dsl::sep(dsl::comma));
+
+  static constexpr auto value =
+      lexy::as_list<std::vector<Ast::expr_ptr>> >>
+      lexy::callback<Ast::expr_ptr>(
+          [](std::string name, std::vector<Ast::expr_ptr> args) -> Ast::expr_ptr {
+            return std::make_shared<Ast::ExprFunction>(name, std::move(args));
+          });
+};
+
 // An arbitrary expression.
 // It uses lexy's built-in support for operator precedence parsing to automatically generate a
 // proper rule. This is done by inheriting from expression_production.
@@ -697,10 +760,15 @@ struct Expression : lexy::expression_production
   static constexpr auto atom = [] {
     auto paren_expr = dsl::parenthesized(dsl::p<nested_expr>);
     auto boolean = dsl::p<BooleanLiteral>;
+    // a name immediately followed by '('
+    auto call =
+        dsl::peek(dsl::identifier(xid_start_character, dsl::unicode::xid_continue) +
+                  dsl::lit_c<'('>) >>
+        dsl::p<FunctionCall>;
     auto var = dsl::p<Name>;
     auto literal = dsl::p<AnyValue>;
 
-    return paren_expr | boolean | var | literal | dsl::error<expected_operand>;
+    return paren_expr | boolean | call | var | literal | dsl::error<expected_operand>;
   }();
 
   // Each of the nested classes defines one operation.
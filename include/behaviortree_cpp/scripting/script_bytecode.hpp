@@ -0,0 +1,152 @@
+/*  Copyright (C) 2022 Davide Faconti -  All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp/scripting/script_parser.hpp"
+
+namespace BT::Ast
+{
+struct ExprBase;
+struct ExprAssignment;
+
+/**
+ * @brief Register-based bytecode, compiled from an expression of the scripting language.
+ *
+ * Only the numeric part of the language is compiled: arithmetic, bitwise,
+ * logic and comparison operators, the ternary operator and the assignment of
+ * their result to a blackboard entry. Intermediate values are stored in registers
+ * as double, instead of Any.
+ *
+ * The type of the variables is known only at run-time: if one of them is
+ * not a number (for instance, a string), execute() gives up and returns false.
+ * Up to that point, it had no side effects, therefore the caller should evaluate
+ * the original expression (ExprBase::evaluate) instead.
+ *
+ * When the table of enums is passed to compile(), the program is "linked":
+ * enums become constants and the subexpressions that contain only
+ * constants are computed once, at compilation time.
+ */
+class ScriptBytecode
+{
+public:
+  enum class OpCode : uint8_t
+  {
+    LOAD_CONST,   // dst = constants[a]
+    LOAD_VAR,     // dst = variable names[a]
+    MOVE,         // dst = a
+    NEGATE,       // dst = -a
+    COMPLEMENT,   // dst = ~a
+    LOGICAL_NOT,  // dst = !a
+    ADD,          // dst = a + b
+    SUB,
+    MUL,
+    DIV,
+    BIT_AND,
+    BIT_OR,
+    BIT_XOR,
+    LOGIC_AND,
+    LOGIC_OR,
+    EQUAL,  // dst = (a == b) ? 1 : 0
+    NOT_EQUAL,
+    LESS,
+    GREATER,
+    LESS_EQUAL,
+    GREATER_EQUAL,
+    JUMP,          // goto a
+    JUMP_IF_FALSE  // if(a == 0) goto b
+  };
+
+  struct Instruction
+  {
+    OpCode op;
+    uint16_t dst = 0;
+    uint16_t a = 0;
+    uint16_t b = 0;
+  };
+
+  // Registers are allocated on the stack by execute(); expressions that
+  // need more than this are not compiled.
+  static constexpr size_t MAX_REGISTERS = 64;
+
+  /**
+   * @brief Blackboard entries used by a program, resolved by name once and reused
+   * by the following calls of execute().
+   *
+   * They are resolved again if the blackboard is different or if any
+   * entry was added or removed from any blackboard (see Blackboard::structureVersion).
+   * Each instance must be used by a single thread at a time.
+   */
+  struct Bindings
+  {
+    const Blackboard* blackboard = nullptr;
+    uint64_t structure_version = 0;
+    // same order of the variable names; nullptr if the entry doesn't exist
+    std::vector<std::shared_ptr<Blackboard::Entry>> entries;
+  };
+
+  /**
+   * @brief compile the expression.
+   *
+   * @param enums  if not null, the enums are replaced by their value and
+   *               the program can be executed only in an Environment with the
+   *               same table of enums.
+   *
+   * @return nullptr if the expression contains something that can not be compiled
+   * (strings, string concatenation...) or if the result of the expression would
+   * not be a number.
+   */
+  static std::unique_ptr<ScriptBytecode> compile(const std::shared_ptr<ExprBase>& expr,
+                                                 const EnumsTable* enums = nullptr);
+
+  /**
+   * @brief execute the bytecode.
+   *
+   * @param env       the environment with the variables and the enums.
+   * @param result    value of the expression, if the function returns true.
+   * @param bindings  optional cache of the blackboard entries. If null,
+   *                  the variables are searched by name.
+   * @return false if a variable used by the expression is not a number
+   * or the result of an operation would be an error; the expression must be
+   * evaluated with ExprBase::evaluate instead.
+   */
+  [[nodiscard]] bool execute(Environment& env, Any& result,
+                             Bindings* bindings = nullptr) const;
+
+  [[nodiscard]] const std::vector<Instruction>& instructions() const
+  {
+    return code_;
+  }
+
+private:
+  friend class BytecodeCompiler;
+
+  std::vector<Instruction> code_;
+  std::vector<double> constants_;
+  std::vector<std::string> names_;
+  uint16_t result_register_ = 0;
+  // if not null, the result is assigned to a blackboard entry
+  std::shared_ptr<ExprAssignment> assignment_;
+  // index of the assigned variable in names_
+  uint16_t assignment_slot_ = 0;
+  // the table of enums used by the compiler, if any
+  const EnumsTable* enums_ = nullptr;
+
+  bool bind(const Environment& env, Bindings& bindings) const;
+};
+
+}  // namespace BT::Ast
@@ -40,10 +40,45 @@ struct Environment
  */
 Result ValidateScript(const std::string& script);
 
+/**
+ * @brief ScriptFunction executes a script in an Environment.
+ *
+ * The functions returned by ParseScript are stateful: at the first execution
+ * they link the bytecode to the enums of the Environment and cache the
+ * blackboard entries it uses. Therefore:
+ *
+ * - a ScriptFunction must not be invoked concurrently by multiple threads;
+ * - a copy has its own state (a copy of the one of the original, at the moment
+ *   of the copy) and it can be used by another thread. Only the immutable
+ *   result of the parsing is shared.
+ */
 using ScriptFunction = std::function<Any(Ast::Environment& env)>;
 
+/**
+ * @brief ParseScript creates a function that executes the script.
+ *
+ * The result of the parsing is cached, using the script as key, and shared by all
+ * the factories and trees: parsing the same script again is cheap.
+ * The cache is bounded; when full, the least recently used script is removed.
+ * The returned function is stateful, see ScriptFunction.
+ */
 Expected<ScriptFunction> ParseScript(const std::string& script);
 
+/**
+ * @brief ScriptDependencies returns the names of the variables read by a script.
+ * The enums are included: they can be told apart from the variables only
+ * when the script is executed.
+ *
+ * It fails if the script is not valid or if it assigns a variable.
+ */
+Expected<std::vector<std::string>> ScriptDependencies(const std::string& script);
+
+/// Number of scripts in the cache used by ParseScript.
+size_t ScriptCacheSize();
+
+/// Remove all the scripts from the cache used by ParseScript.
+void ClearScriptCache();
+
 Expected<Any> ParseScriptAndExecute(Ast::Environment& env, const std::string& script);
 
 }  // namespace BT
@@ -0,0 +1,298 @@
+/*  Copyright (C) 2024 Davide Faconti -  All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "behaviortree_cpp/action_node.h"
+
+/**
+ * Compile-time composition of trees.
+ *
+ * Leaves are plain classes (not TreeNodes) with the method:
+ *
+ *     BT::NodeStatus tick(BT::TreeNode& node);
+ *
+ * where "node" is the StaticTree that contains them; use it to read and write
+ * the ports, for instance node.getInput<int>("value"). Optionally, leaves
+ * may have a method halt() and a static method providedPorts().
+ *
+ * Leaves are composed with the templates of the namespace BT::Static:
+ *
+ *     using ChargeAndMove = BT::Static::Sequence<
+ *                               BT::Static::Fallback<IsBatteryOk, Charge>, MoveTo>;
+ *
+ *     factory.registerNodeType<BT::StaticTree<ChargeAndMove>>("ChargeAndMove");
+ *
+ * The type of each child is known at compile time, therefore the compiler can
+ * inline the whole control flow. From the point of view of the rest of the
+ * library, StaticTree is a single action: it can be used in the XML like any
+ * other node, loggers and Groot2 see it, but not its internal structure.
+ * Its ports are the union of the ports of the leaves.
+ */
+namespace BT::Static
+{
+namespace details
+{
+template <typename T, typename = void>
+struct has_halt : std::false_type
+{
+};
+
+template <typename T>
+struct has_halt<T, std::void_t<decltype(std::declval<T&>().halt())>> : std::true_type
+{
+};
+
+template <typename T>
+inline void HaltChild(T& child)
+{
+  if constexpr(has_halt<T>::value)
+  {
+    child.halt();
+  }
+}
+
+// A port used with different directions by two leaves becomes INOUT
+inline void MergePorts(PortsList& ports, const PortsList& other)
+{
+  for(const auto& [name, info] : other)
+  {
+    auto [it, inserted] = ports.insert({ name, info });
+    if(!inserted && it->second.direction() != info.direction())
+    {
+      auto merged =
+          PortInfo(PortDirection::INOUT, it->second.type(), it->second.converter());
+      merged.setDescription(it->second.description());
+      it->second = std::move(merged);
+    }
+  }
+}
+
+template <typename... Children>
+inline PortsList MergePorts()
+{
+  PortsList ports;
+  (MergePorts(ports, getProvidedPorts<Children>()), ...);
+  return ports;
+}
+
+/// Implementation of Sequence and Fallback: they differ only in the
+/// status that stops the loop
+template <NodeStatus StopStatus, typename... Children>
+class Composite
+{
+public:
+  static_assert(sizeof...(Children) > 0, "A control node needs at least one child");
+
+  NodeStatus tick(TreeNode& node)
+  {
+    return tickChild<0>(node);
+  }
+
+  void halt()
+  {
+    if(running_)
+    {
+      haltChild<0>();
+    }
+    current_ = 0;
+    skipped_count_ = 0;
+    running_ = false;
+  }
+
+  static PortsList providedPorts()
+  {
+    return MergePorts<Children...>();
+  }
+
+private:
+  static constexpr size_t COUNT = sizeof...(Children);
+  std::tuple<Children...> children_;
+  size_t current_ = 0;
+  size_t skipped_count_ = 0;
+  bool running_ = false;
+
+  template <size_t I>
+  NodeStatus tickChild(TreeNode& node)
+  {
+    if constexpr(I == COUNT)
+    {
+      const bool all_skipped = (skipped_count_ == COUNT);
+      current_ = 0;
+      skipped_count_ = 0;
+      running_ = false;
+      if(all_skipped)
+      {
+        return NodeStatus::SKIPPED;
+      }
+      return (StopStatus == NodeStatus::FAILURE) ? NodeStatus::SUCCESS :
+                                                   NodeStatus::FAILURE;
+    }
+    else
+    {
+      // resume from the child that returned RUNNING
+      if(I < current_)
+      {
+        return tickChild<I + 1>(node);
+      }
+      const NodeStatus status = std::get<I>(children_).tick(node);
+      if(status == NodeStatus::RUNNING)
+      {
+        current_ = I;
+        running_ = true;
+        return status;
+      }
+      if(status == StopStatus)
+      {
+        current_ = 0;
+        skipped_count_ = 0;
+        running_ = false;
+        return status;
+      }
+      if(status == NodeStatus::SKIPPED)
+      {
+        skipped_count_++;
+      }
+      return tickChild<I + 1>(node);
+    }
+  }
+
+  template <size_t I>
+  void haltChild()
+  {
+    if constexpr(I < COUNT)
+    {
+      if(I == current_)
+      {
+        HaltChild(std::get<I>(children_));
+        return;
+      }
+      haltChild<I + 1>();
+    }
+  }
+};
+
+/// Apply a function to the status of the child
+template <typename Child, NodeStatus (*Convert)(NodeStatus)>
+class Decorator
+{
+public:
+  NodeStatus tick(TreeNode& node)
+  {
+    const NodeStatus status = child_.tick(node);
+    running_ = (status == NodeStatus::RUNNING);
+    return Convert(status);
+  }
+
+  void halt()
+  {
+    if(running_)
+    {
+      HaltChild(child_);
+    }
+    running_ = false;
+  }
+
+  static PortsList providedPorts()
+  {
+    return getProvidedPorts<Child>();
+  }
+
+private:
+  Child child_;
+  bool running_ = false;
+};
+
+constexpr NodeStatus Invert(NodeStatus status)
+{
+  switch(status)
+  {
+    case NodeStatus::SUCCESS:
+      return NodeStatus::FAILURE;
+    case NodeStatus::FAILURE:
+      return NodeStatus::SUCCESS;
+    default:
+      return status;
+  }
+}
+
+constexpr NodeStatus ToSuccess(NodeStatus status)
+{
+  return (status == NodeStatus::FAILURE) ? NodeStatus::SUCCESS : status;
+}
+
+constexpr NodeStatus ToFailure(NodeStatus status)
+{
+  return (status == NodeStatus::SUCCESS) ? NodeStatus::FAILURE : status;
+}
+
+}  // namespace details
+
+/// Same as SequenceNode: tick the children in order until one of them fails.
+template <typename... Children>
+using Sequence = details::Composite<NodeStatus::FAILURE, Children...>;
+
+/// Same as FallbackNode: tick the children in order until one of them succeeds.
+template <typename... Children>
+using Fallback = details::Composite<NodeStatus::SUCCESS, Children...>;
+
+template <typename Child>
+using Inverter = details::Decorator<Child, details::Invert>;
+
+template <typename Child>
+using ForceSuccess = details::Decorator<Child, details::ToSuccess>;
+
+template <typename Child>
+using ForceFailure = details::Decorator<Child, details::ToFailure>;
+
+}  // namespace BT::Static
+
+namespace BT
+{
+/**
+ * @brief StaticTree is the TreeNode that contains a tree composed at
+ * compile time with the templates of BT::Static.
+ */
+template <typename Root>
+class StaticTree : public ActionNodeBase
+{
+public:
+  StaticTree(const std::string& name, const NodeConfig& config)
+    : ActionNodeBase(name, config)
+  {}
+
+  static PortsList providedPorts()
+  {
+    return getProvidedPorts<Root>();
+  }
+
+  void halt() override
+  {
+    Static::details::HaltChild(root_);
+    resetStatus();
+  }
+
+protected:
+  NodeStatus tick() override
+  {
+    return root_.tick(*this);
+  }
+
+private:
+  Root root_;
+};
+
+}  // namespace BT
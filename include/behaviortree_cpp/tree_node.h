@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <exception>
 #include <map>
 #include <utility>
@@ -171,6 +172,51 @@ public:
 
   virtual NodeType type() const = 0;
 
+  /// Non-owning view of the children of a node, see children()
+  class Children
+  {
+  public:
+    Children() = default;
+    Children(TreeNode* const* data, size_t size) : data_(data), size_(size)
+    {}
+
+    [[nodiscard]] TreeNode* const* begin() const
+    {
+      return data_;
+    }
+    [[nodiscard]] TreeNode* const* end() const
+    {
+      return data_ + size_;
+    }
+    [[nodiscard]] size_t size() const
+    {
+      return size_;
+    }
+    [[nodiscard]] bool empty() const
+    {
+      return size_ == 0;
+    }
+    [[nodiscard]] TreeNode* operator[](size_t index) const
+    {
+      return data_[index];
+    }
+
+  private:
+    TreeNode* const* data_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  /**
+   * @brief children of a ControlNode, or the child of a DecoratorNode
+   * (including SubTreeNode). Empty for the leaves and for a decorator
+   * without child.
+   *
+   * It doesn't allocate and it doesn't need dynamic_cast: ControlNode and
+   * DecoratorNode store their NodeType in the base class when constructed.
+   * The view is invalidated by ControlNode::addChild().
+   */
+  [[nodiscard]] Children children() const;
+
   using StatusChangeSignal = Signal<TimePoint, const TreeNode&, NodeStatus, NodeStatus>;
   using StatusChangeSubscriber = StatusChangeSignal::Subscriber;
   using StatusChangeCallback = StatusChangeSignal::CallableFunction;
@@ -231,6 +277,11 @@ public:
   /// See tutorial 10 as an example.
   [[nodiscard]] const std::string& fullPath() const;
 
+  /// True if, while RUNNING, this node doesn't need to be ticked again until
+  /// emitWakeUpSignal() is called or the blackboard changes.
+  /// See Tree::tickOnceIfNeeded().
+  [[nodiscard]] bool waitsForEvents() const;
+
   /// registrationName is the ID used by BehaviorTreeFactory to create an instance.
   [[nodiscard]] const std::string& registrationName() const;
 
@@ -339,6 +390,10 @@ public:
   // in the port (no remapping and no conversion to a type)
   [[nodiscard]] StringView getRawPortValue(const std::string& key) const;
 
+  /// Return true if the input port is missing or contains a literal value, i.e.
+  /// it is not remapped to the blackboard: its value can't change after construction.
+  [[nodiscard]] bool isStaticInput(const std::string& key) const;
+
   /// Check a string and return true if it matches the pattern:  {...}
   [[nodiscard]] static bool isBlackboardPointer(StringView str,
                                                 StringView* stripped_pointer = nullptr);
@@ -397,6 +452,16 @@ protected:
 
   void modifyPortsRemapping(const PortsRemapping& new_remapping);
 
+  /// To be called by the nodes that, when RUNNING, emit the wake-up signal
+  /// as soon as they need to be ticked (a thread or a timer completed).
+  /// See waitsForEvents().
+  void setWaitForEvents(bool enable);
+
+  /// Called by executeTick() when the node returns RUNNING. The nodes that
+  /// override executeTick(), like ThreadedAction, must call it too,
+  /// otherwise Tree::tickOnceIfNeeded() can't skip any tick.
+  void notifyRunning();
+
   /**
      * @brief setStatus changes the status of the node.
      * it will throw if you try to change the status to IDLE, because
@@ -417,6 +482,23 @@ private:
   struct PImpl;
   std::unique_ptr<PImpl> _p;
 
+  // Called by the constructors of ControlNode and DecoratorNode, see children()
+  void setChildrenType(NodeType type);
+
+  // Called by ControlNode::addChild(): the bit "mask" of "word" is set
+  // when the status of this node is not IDLE.
+  void setActiveFlag(std::shared_ptr<std::atomic<uint64_t>> word, uint64_t mask);
+
+  // Called by BehaviorTreeFactory for the nodes with the attribute _memoize:
+  // tick() is skipped while the blackboard entries "keys" don't change.
+  void setMemoizedKeys(std::vector<std::string> keys);
+  NodeStatus tickMemoized();
+
+  // Called by BehaviorTreeFactory for the nodes with the attribute _period:
+  // between two periods, executeTick() returns the previous status without
+  // ticking the node and its children.
+  void setTickPeriod(std::chrono::microseconds period);
+
   Expected<NodeStatus> checkPreConditions();
   void checkPostConditions(NodeStatus status);
 
@@ -61,47 +61,95 @@ class Any
   template <typename T>
   nonstd::expected<T, std::string> stringToNumber() const;
 
+  // Category of the value stored in _any. It is set once, when the value is
+  // stored, and it allows the most common queries and casts to skip the
+  // comparison of std::type_info.
+  enum class Kind : uint8_t
+  {
+    EMPTY,
+    INT64,
+    UINT64,
+    DOUBLE,
+    STRING,
+    OTHER
+  };
+
+  template <typename T>
+  static constexpr Kind kindOf()
+  {
+    if constexpr(std::is_same_v<T, int64_t>)
+    {
+      return Kind::INT64;
+    }
+    else if constexpr(std::is_same_v<T, uint64_t>)
+    {
+      return Kind::UINT64;
+    }
+    else if constexpr(std::is_same_v<T, double>)
+    {
+      return Kind::DOUBLE;
+    }
+    else if constexpr(std::is_same_v<T, SafeAny::SimpleString>)
+    {
+      return Kind::STRING;
+    }
+    return Kind::OTHER;
+  }
+
 public:
   Any() : _original_type(UndefinedAnyType)
   {}
 
   ~Any() = default;
 
-  Any(const Any& other) : _any(other._any), _original_type(other._original_type)
+  Any(const Any& other)
+    : _any(other._any), _original_type(other._original_type), _kind(other._kind)
   {}
 
-  Any(Any&& other) : _any(std::move(other._any)), _original_type(other._original_type)
-  {}
+  Any(Any&& other) noexcept
+    : _any(std::move(other._any)), _original_type(other._original_type), _kind(other._kind)
+  {
+    other._kind = Kind::EMPTY;
+  }
 
-  explicit Any(const double& value) : _any(value), _original_type(typeid(double))
+  explicit Any(const double& value)
+    : _any(value), _original_type(typeid(double)), _kind(Kind::DOUBLE)
   {}
 
-  explicit Any(const uint64_t& value) : _any(value), _original_type(typeid(uint64_t))
+  explicit Any(const uint64_t& value)
+    : _any(value), _original_type(typeid(uint64_t)), _kind(Kind::UINT64)
   {}
 
-  explicit Any(const float& value) : _any(double(value)), _original_type(typeid(float))
+  explicit Any(const float& value)
+    : _any(double(value)), _original_type(typeid(float)), _kind(Kind::DOUBLE)
   {}
 
   explicit Any(const std::string& str)
-    : _any(SafeAny::SimpleString(str)), _original_type(typeid(std::string))
+    : _any(SafeAny::SimpleString(str))
+    , _original_type(typeid(std::string))
+    , _kind(Kind::STRING)
   {}
 
   explicit Any(const char* str)
-    : _any(SafeAny::SimpleString(str)), _original_type(typeid(std::string))
+    : _any(SafeAny::SimpleString(str))
+    , _original_type(typeid(std::string))
+    , _kind(Kind::STRING)
   {}
 
   explicit Any(const SafeAny::SimpleString& str)
-    : _any(str), _original_type(typeid(std::string))
+    : _any(str), _original_type(typeid(std::string)), _kind(Kind::STRING)
   {}
 
   explicit Any(const std::string_view& str)
-    : _any(SafeAny::SimpleString(str)), _original_type(typeid(std::string))
+    : _any(SafeAny::SimpleString(str))
+    , _original_type(typeid(std::string))
+    , _kind(Kind::STRING)
   {}
 
   // all the other integrals are casted to int64_t
   template <typename T>
   explicit Any(const T& value, EnableIntegral<T> = 0)
-    : _any(int64_t(value)), _original_type(typeid(T))
+    : _any(int64_t(value)), _original_type(typeid(T)), _kind(Kind::INT64)
   {}
 
   Any(const std::type_index& type) : _original_type(type)
@@ -110,20 +158,28 @@ public:
   // default for other custom types
   template <typename T>
   explicit Any(const T& value, EnableNonIntegral<T> = 0)
-    : _any(value), _original_type(typeid(T))
+    : _any(value), _original_type(typeid(T)), _kind(kindOf<T>())
   {
     static_assert(!std::is_reference<T>::value, "Any can not contain references");
   }
 
   Any& operator=(const Any& other);
 
-  [[nodiscard]] bool isNumber() const;
+  Any& operator=(Any&& other) noexcept;
 
-  [[nodiscard]] bool isIntegral() const;
+  [[nodiscard]] bool isNumber() const
+  {
+    return _kind == Kind::INT64 || _kind == Kind::UINT64 || _kind == Kind::DOUBLE;
+  }
+
+  [[nodiscard]] bool isIntegral() const
+  {
+    return _kind == Kind::INT64 || _kind == Kind::UINT64;
+  }
 
   [[nodiscard]] bool isString() const
   {
-    return _any.type() == typeid(SafeAny::SimpleString);
+    return _kind == Kind::STRING;
   }
 
   // check is the original type is equal to T
@@ -136,6 +192,11 @@ public:
   // copy the value (casting into dst). We preserve the destination type.
   void copyInto(Any& dst) const;
 
+  // Non-throwing conversion of a number to double, used by the scripting language.
+  // It returns false if the value is not a number or if it can't be represented
+  // exactly as a double (the same cases in which cast<double>() would fail).
+  [[nodiscard]] bool tryCastNumber(double& out) const noexcept;
+
   // this is different from any_cast, because if allows safe
   // conversions between arithmetic values and from/to string.
   template <typename T>
@@ -187,6 +248,15 @@ public:
 private:
   linb::any _any;
   std::type_index _original_type;
+  Kind _kind = Kind::EMPTY;
+
+  // access the stored value without type checking. Use it only
+  // after checking _kind
+  template <typename T>
+  const T& storedValue() const noexcept
+  {
+    return *linb::unchecked_any_cast<T>(&_any);
+  }
 
   //----------------------------
 
@@ -307,18 +377,17 @@ inline Any& Any::operator=(const Any& other)
 {
   this->_any = other._any;
   this->_original_type = other._original_type;
+  this->_kind = other._kind;
   return *this;
 }
 
-inline bool Any::isNumber() const
-{
-  return _any.type() == typeid(int64_t) || _any.type() == typeid(uint64_t) ||
-         _any.type() == typeid(double);
-}
-
-inline bool Any::isIntegral() const
+inline Any& Any::operator=(Any&& other) noexcept
 {
-  return _any.type() == typeid(int64_t) || _any.type() == typeid(uint64_t);
+  this->_any = std::move(other._any);
+  this->_original_type = other._original_type;
+  this->_kind = other._kind;
+  other._kind = Kind::EMPTY;
+  return *this;
 }
 
 inline void Any::copyInto(Any& dst) const
@@ -329,29 +398,24 @@ inline void Any::copyInto(Any& dst) const
     return;
   }
 
-  const auto& dst_type = dst.castedType();
-
-  if((castedType() == dst_type) || (isString() && dst.isString()))
+  if(_kind == dst._kind &&
+     (_kind != Kind::OTHER || castedType() == dst.castedType()))
   {
     dst._any = _any;
   }
   else if(isNumber() && dst.isNumber())
   {
-    if(dst_type == typeid(int64_t))
-    {
-      dst._any = cast<int64_t>();
-    }
-    else if(dst_type == typeid(uint64_t))
-    {
-      dst._any = cast<uint64_t>();
-    }
-    else if(dst_type == typeid(double))
-    {
-      dst._any = cast<double>();
-    }
-    else
+    switch(dst._kind)
     {
-      throw std::runtime_error("Any::copyInto fails");
+      case Kind::INT64:
+        dst._any = cast<int64_t>();
+        break;
+      case Kind::UINT64:
+        dst._any = cast<uint64_t>();
+        break;
+      default:
+        dst._any = cast<double>();
+        break;
     }
   }
   else
@@ -360,28 +424,53 @@ inline void Any::copyInto(Any& dst) const
   }
 }
 
+inline bool Any::tryCastNumber(double& out) const noexcept
+{
+  constexpr int64_t max_exact = (int64_t(1) << std::numeric_limits<double>::digits) - 1;
+  switch(_kind)
+  {
+    case Kind::DOUBLE:
+      out = storedValue<double>();
+      return true;
+    case Kind::INT64: {
+      const auto value = storedValue<int64_t>();
+      if(value > max_exact || value < -max_exact)
+      {
+        return false;
+      }
+      out = static_cast<double>(value);
+      return true;
+    }
+    case Kind::UINT64: {
+      const auto value = storedValue<uint64_t>();
+      if(value > static_cast<uint64_t>(max_exact))
+      {
+        return false;
+      }
+      out = static_cast<double>(value);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
 template <typename DST>
 inline nonstd::expected<DST, std::string> Any::convert(EnableString<DST>) const
 {
-  const auto& type = _any.type();
-
-  if(type == typeid(SafeAny::SimpleString))
-  {
-    return linb::any_cast<SafeAny::SimpleString>(_any).toStdString();
-  }
-  else if(type == typeid(int64_t))
-  {
-    return std::to_string(linb::any_cast<int64_t>(_any));
+  switch(_kind)
+  {
+    case Kind::STRING:
+      return storedValue<SafeAny::SimpleString>().toStdString();
+    case Kind::INT64:
+      return std::to_string(storedValue<int64_t>());
+    case Kind::UINT64:
+      return std::to_string(storedValue<uint64_t>());
+    case Kind::DOUBLE:
+      return std::to_string(storedValue<double>());
+    default:
+      break;
   }
-  else if(type == typeid(uint64_t))
-  {
-    return std::to_string(linb::any_cast<uint64_t>(_any));
-  }
-  else if(type == typeid(double))
-  {
-    return std::to_string(linb::any_cast<double>(_any));
-  }
-
   return nonstd::make_unexpected(errorMsg<DST>());
 }
 
@@ -391,7 +480,7 @@ inline nonstd::expected<T, std::string> Any::stringToNumber() const
   static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "Expecting a "
                                                                      "numeric type");
 
-  const auto str = linb::any_cast<SafeAny::SimpleString>(_any);
+  const auto& str = storedValue<SafeAny::SimpleString>();
 #if __cpp_lib_to_chars >= 201611L
   T out;
   auto [ptr, err] = std::from_chars(str.data(), str.data() + str.size(), out);
@@ -434,17 +523,13 @@ inline nonstd::expected<DST, std::string> Any::convert(EnableEnum<DST>) const
 {
   using SafeAny::details::convertNumber;
 
-  const auto& type = _any.type();
-
-  if(type == typeid(int64_t))
+  if(_kind == Kind::INT64)
   {
-    auto out = linb::any_cast<int64_t>(_any);
-    return static_cast<DST>(out);
+    return static_cast<DST>(storedValue<int64_t>());
   }
-  else if(type == typeid(uint64_t))
+  else if(_kind == Kind::UINT64)
   {
-    auto out = linb::any_cast<uint64_t>(_any);
-    return static_cast<DST>(out);
+    return static_cast<DST>(storedValue<uint64_t>());
   }
 
   return nonstd::make_unexpected(errorMsg<DST>());
@@ -456,23 +541,19 @@ inline nonstd::expected<DST, std::string> Any::convert(EnableArithmetic<DST>) co
   using SafeAny::details::convertNumber;
   DST out;
 
-  const auto& type = _any.type();
-
-  if(type == typeid(int64_t))
-  {
-    convertNumber<int64_t, DST>(linb::any_cast<int64_t>(_any), out);
-  }
-  else if(type == typeid(uint64_t))
-  {
-    convertNumber<uint64_t, DST>(linb::any_cast<uint64_t>(_any), out);
-  }
-  else if(type == typeid(double))
+  switch(_kind)
   {
-    convertNumber<double, DST>(linb::any_cast<double>(_any), out);
-  }
-  else
-  {
-    return nonstd::make_unexpected(errorMsg<DST>());
+    case Kind::INT64:
+      convertNumber<int64_t, DST>(storedValue<int64_t>(), out);
+      break;
+    case Kind::UINT64:
+      convertNumber<uint64_t, DST>(storedValue<uint64_t>(), out);
+      break;
+    case Kind::DOUBLE:
+      convertNumber<double, DST>(storedValue<double>(), out);
+      break;
+    default:
+      return nonstd::make_unexpected(errorMsg<DST>());
   }
   return out;
 }
@@ -488,9 +569,17 @@ inline nonstd::expected<T, std::string> Any::tryCast() const
     throw std::runtime_error("Any::cast failed because it is empty");
   }
 
-  if(castedType() == typeid(T))
+  // fast path: the value is stored exactly as T
+  if constexpr(kindOf<T>() != Kind::OTHER)
+  {
+    if(_kind == kindOf<T>())
+    {
+      return storedValue<T>();
+    }
+  }
+  else if(castedType() == typeid(T))
   {
-    return linb::any_cast<T>(_any);
+    return *linb::any_cast<T>(&_any);
   }
 
   // special case when the output is an enum.
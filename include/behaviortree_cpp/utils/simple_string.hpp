@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <cstring>
 #include <stdexcept>
@@ -12,6 +13,8 @@ namespace SafeAny
 
 // Read only version of String that has size 16 bytes and can store
 // in-place strings with size up to 15 bytes.
+// Longer strings are stored in an immutable buffer shared, with reference
+// counting, by all the copies: copying a SimpleString never allocates.
 
 // Inspired by https://github.com/elliotgoodrich/SSO-23
 
@@ -24,25 +27,32 @@ public:
   SimpleString(const std::string_view& str) : SimpleString(str.data(), str.size())
   {}
 
-  SimpleString(const SimpleString& other) : SimpleString(other.data(), other.size())
-  {}
+  SimpleString(const SimpleString& other) noexcept : _storage(other._storage)
+  {
+    if(!isSOO())
+    {
+      header()->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
 
-  SimpleString& operator=(const SimpleString& other)
+  SimpleString& operator=(const SimpleString& other) noexcept
   {
-    this->~SimpleString();
-    createImpl(other.data(), other.size());
+    if(this != &other)
+    {
+      SimpleString tmp(other);
+      std::swap(_storage, tmp._storage);
+    }
     return *this;
   }
 
-  SimpleString(SimpleString&& other) : SimpleString(nullptr, 0)
+  // moves must be noexcept, otherwise BT::Any would allocate the string on the heap
+  SimpleString(SimpleString&& other) noexcept : SimpleString(nullptr, 0)
   {
     std::swap(_storage, other._storage);
   }
 
-  SimpleString& operator=(SimpleString&& other)
+  SimpleString& operator=(SimpleString&& other) noexcept
   {
-    this->~SimpleString();
-
     std::swap(_storage, other._storage);
     return *this;
   }
@@ -57,9 +67,11 @@ public:
 
   ~SimpleString()
   {
-    if(!isSOO())
+    if(!isSOO() &&
+       header()->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
     {
-      delete[] _storage.str.data;
+      header()->~Header();
+      ::operator delete(header());
     }
     _storage.soo.capacity_left = CAPACITY;
   }
@@ -97,36 +109,46 @@ public:
     }
   }
 
+  // true if the two strings share the same buffer. In that case,
+  // they are equal without comparing their content.
+  bool sharesBufferWith(const SimpleString& other) const
+  {
+    return !isSOO() && !other.isSOO() && _storage.str.data == other._storage.str.data;
+  }
+
   bool operator==(const SimpleString& other) const
   {
+    if(sharesBufferWith(other))
+    {
+      return true;
+    }
     size_t N = size();
-    return other.size() == N && std::strncmp(data(), other.data(), N) == 0;
+    return other.size() == N && std::memcmp(data(), other.data(), N) == 0;
   }
 
   bool operator!=(const SimpleString& other) const
   {
-    size_t N = size();
-    return other.size() != N || std::strncmp(data(), other.data(), N) != 0;
+    return !(*this == other);
   }
 
   bool operator<=(const SimpleString& other) const
   {
-    return std::strcmp(data(), other.data()) <= 0;
+    return sharesBufferWith(other) || std::strcmp(data(), other.data()) <= 0;
   }
 
   bool operator>=(const SimpleString& other) const
   {
-    return std::strcmp(data(), other.data()) >= 0;
+    return sharesBufferWith(other) || std::strcmp(data(), other.data()) >= 0;
   }
 
   bool operator<(const SimpleString& other) const
   {
-    return std::strcmp(data(), other.data()) < 0;
+    return !sharesBufferWith(other) && std::strcmp(data(), other.data()) < 0;
   }
 
   bool operator>(const SimpleString& other) const
   {
-    return std::strcmp(data(), other.data()) > 0;
+    return !sharesBufferWith(other) && std::strcmp(data(), other.data()) > 0;
   }
 
   bool isSOO() const
@@ -141,6 +163,12 @@ private:
     std::size_t size;
   };
 
+  // placed in memory right before the characters of a long string
+  struct Header
+  {
+    std::atomic<std::size_t> ref_count;
+  };
+
   constexpr static std::size_t CAPACITY = 15;  // sizeof(String) - 1);
   constexpr static std::size_t IS_LONG_BIT = 1 << 7;
   constexpr static std::size_t LONG_MASK = (~std::size_t(0)) >> 1;
@@ -158,6 +186,11 @@ private:
   } _storage;
 
 private:
+  Header* header() const
+  {
+    return reinterpret_cast<Header*>(_storage.str.data - sizeof(Header));
+  }
+
   void createImpl(const char* input_data, std::size_t size)
   {
     if(size > MAX_SIZE)
@@ -167,9 +200,11 @@ private:
 
     if(size > CAPACITY)
     {
+      auto* buffer = static_cast<char*>(::operator new(sizeof(Header) + size + 1));
+      new(buffer) Header{ 1 };
       _storage.str.size = size;
       _storage.soo.capacity_left = IS_LONG_BIT;
-      _storage.str.data = new char[size + 1];
+      _storage.str.data = buffer + sizeof(Header);
       std::memcpy(_storage.str.data, input_data, size);
       _storage.str.data[size] = '\0';
     }
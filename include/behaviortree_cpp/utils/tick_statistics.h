@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace BT
+{
+/**
+ * @brief TickStatistics collects the timing of the ticks executed by
+ * Tree::tickAtFixedRate(): duration, jitter of the period, overruns of the
+ * budget and missed deadlines.
+ *
+ * The counters and the maximum values cover all the ticks, the percentiles
+ * only the last "window" ticks, to use a constant amount of memory.
+ */
+class TickStatistics
+{
+public:
+  using Duration = std::chrono::microseconds;
+
+  explicit TickStatistics(size_t window = 1000);
+
+  void reset();
+
+  /// Add a tick that lasted "duration"; "overrun" if it exceeded the budget.
+  void addTick(Duration duration, bool overrun);
+
+  /// Add the difference between the start of a tick and the scheduled one.
+  /// The periods that were skipped are counted by addMissedDeadlines().
+  void addJitter(Duration jitter);
+
+  void addMissedDeadlines(uint64_t count);
+
+  [[nodiscard]] uint64_t tickCount() const
+  {
+    return tick_count_;
+  }
+
+  [[nodiscard]] uint64_t overrunCount() const
+  {
+    return overrun_count_;
+  }
+
+  /// Number of periods that were skipped because a tick ended after
+  /// the start of the following one.
+  [[nodiscard]] uint64_t missedDeadlineCount() const
+  {
+    return missed_deadlines_;
+  }
+
+  [[nodiscard]] Duration maxDuration() const
+  {
+    return max_duration_;
+  }
+
+  /// Maximum and mean of the absolute value of the jitter.
+  [[nodiscard]] Duration maxJitter() const
+  {
+    return max_jitter_;
+  }
+
+  [[nodiscard]] Duration meanJitter() const;
+
+  /// Percentile (between 0 and 100) of the duration of the last ticks,
+  /// with the nearest-rank method. Zero if there are no ticks.
+  [[nodiscard]] Duration durationPercentile(double percentile) const;
+
+private:
+  size_t window_;
+  // circular buffer of the last durations
+  std::vector<Duration> durations_;
+  size_t next_ = 0;
+
+  uint64_t tick_count_ = 0;
+  uint64_t overrun_count_ = 0;
+  uint64_t missed_deadlines_ = 0;
+  Duration max_duration_ = Duration(0);
+
+  uint64_t jitter_count_ = 0;
+  Duration jitter_sum_ = Duration(0);
+  Duration max_jitter_ = Duration(0);
+};
+
+}  // namespace BT
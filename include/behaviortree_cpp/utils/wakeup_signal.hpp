@@ -5,6 +5,7 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 
 namespace BT
 {
@@ -24,14 +25,32 @@ public:
 
   void emitSignal()
   {
+    emitted_count_.fetch_add(1, std::memory_order_acq_rel);
     ready_ = true;
     cv_.notify_all();
   }
 
+  /// Number of signals emitted so far. Unlike the flag used by waitFor(),
+  /// it is not reset: it tells if a signal was emitted since a given moment.
+  uint64_t emittedCount() const
+  {
+    return emitted_count_.load(std::memory_order_acquire);
+  }
+
+  // Bookkeeping of Tree::tickOnceIfNeeded(), updated by TreeNode::executeTick():
+  // the number of nodes that returned RUNNING and if any of them must be
+  // ticked again even if nothing changed.
+  uint64_t running_count = 0;
+  bool polling_requested = false;
+  // the earliest moment when a node with the attribute _period must be ticked
+  std::chrono::steady_clock::time_point next_deadline =
+      std::chrono::steady_clock::time_point::max();
+
 private:
   std::mutex mutex_;
   std::condition_variable cv_;
   std::atomic_bool ready_ = false;
+  std::atomic<uint64_t> emitted_count_ = 0;
 };
 
 }  // namespace BT
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BT
+{
+/**
+ * @brief WildcardIndex finds which of many wildcard filters (same syntax of
+ * WildcardMatch) match a string, without testing all of them.
+ *
+ * Filters without wildcards are stored in a hash table, the others in a trie,
+ * using the characters that precede the first wildcard. Only the filters found
+ * along the path of the string in the trie are tested with WildcardMatch,
+ * unless they are in the form "prefix*".
+ * Each filter is identified by its index, i.e. the order of insertion.
+ */
+class WildcardIndex
+{
+public:
+  static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+  /// Add a filter and return its index. Adding the same filter again
+  /// returns the index of the first insertion.
+  size_t add(const std::string& filter);
+
+  void reserve(size_t count);
+
+  void clear();
+
+  [[nodiscard]] size_t size() const
+  {
+    return filters_.size();
+  }
+
+  [[nodiscard]] const std::string& filter(size_t index) const
+  {
+    return filters_[index];
+  }
+
+  /// Lowest index of the filters that match str, or NONE.
+  [[nodiscard]] size_t firstMatch(const std::string& str) const;
+
+  /// Index of the filter equal to str (wildcards are not expanded), or NONE.
+  [[nodiscard]] size_t find(const std::string& str) const;
+
+  /// True if the filter doesn't contain any wildcard.
+  [[nodiscard]] static bool isLiteral(const std::string& filter);
+
+  /// Number of characters that precede the first wildcard.
+  [[nodiscard]] static size_t literalPrefixLength(const std::string& filter);
+
+private:
+  struct TrieNode
+  {
+    std::unordered_map<char, uint32_t> children;
+    // first filter in the form "prefix*"
+    size_t prefix_filter = NONE;
+    // other filters with this prefix, in ascending order
+    std::vector<size_t> filters;
+  };
+
+  std::vector<std::string> filters_;
+  std::vector<bool> literal_;
+  // all the filters
+  std::unordered_map<std::string, size_t> exact_;
+  // filters with wildcards. The root is the empty prefix
+  std::vector<TrieNode> trie_ = std::vector<TrieNode>(1);
+};
+
+}  // namespace BT
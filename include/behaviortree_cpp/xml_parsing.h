@@ -18,6 +18,7 @@ class XMLParser : public Parser
 public:
   XMLParser(const BehaviorTreeFactory& factory);
 
+
   ~XMLParser() override;
 
   XMLParser(const XMLParser& other) = delete;
@@ -38,6 +39,10 @@ public:
 
   void clearInternalState() override;
 
+  [[nodiscard]] TreeTemplate::Ptr compileTree(const std::string& tree_name) override;
+
+  std::vector<std::string> reloadTree(Tree& tree, const std::string& xml_text) override;
+
 private:
   struct PImpl;
   std::unique_ptr<PImpl> _p;
@@ -58,6 +63,29 @@ void VerifyXML(const std::string& xml_text,
 [[nodiscard]] std::string writeTreeNodesModelXML(const BehaviorTreeFactory& factory,
                                                  bool include_builtin = false);
 
+/**
+ * @brief readTreeNodesModelXML parses the manifests written by writeTreeNodesModelXML.
+ * The models of the SubTrees are ignored.
+ *
+ * The type of the ports is not restored: they accept any type.
+ */
+[[nodiscard]] std::vector<TreeNodeManifest>
+readTreeNodesModelXML(const std::string& xml_text);
+
+/**
+ * @brief writePluginManifestXML generates the cache used by
+ * BehaviorTreeFactory::registerFromPluginManifest(): the <TreeNodesModel>
+ * of writeTreeNodesModelXML() and the scripting enums of the factory.
+ */
+[[nodiscard]] std::string writePluginManifestXML(const BehaviorTreeFactory& factory);
+
+/**
+ * @brief readScriptingEnumsXML parses the scripting enums written by
+ * writePluginManifestXML().
+ */
+[[nodiscard]] std::vector<std::pair<std::string, int>>
+readScriptingEnumsXML(const std::string& xml_text);
+
 /**
  * @brief writeTreeXSD generates an XSD for the nodes defined in the factory
  *
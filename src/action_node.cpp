@@ -227,7 +227,12 @@ NodeStatus BT::ThreadedAction::executeTick()
     exptr_ = nullptr;
     std::rethrow_exception(exptr_copy);
   }
-  return status();
+  const auto current_status = status();
+  if(current_status == NodeStatus::RUNNING)
+  {
+    notifyRunning();
+  }
+  return current_status;
 }
 
 void ThreadedAction::halt()
@@ -5,7 +5,10 @@ namespace BT
 
 SleepNode::SleepNode(const std::string& name, const NodeConfig& config)
   : StatefulActionNode(name, config), timer_waiting_(false)
-{}
+{
+  // the timer emits the wake-up signal
+  setWaitForEvents(true);
+}
 
 NodeStatus SleepNode::onStart()
 {
@@ -26,11 +29,12 @@ NodeStatus SleepNode::onStart()
 
   timer_id_ = timer_.add(std::chrono::milliseconds(msec), [this](bool aborted) {
     std::unique_lock<std::mutex> lk(delay_mutex_);
+    // clear the flag first: a tick that sees the signal must see the flag too
+    timer_waiting_ = false;
     if(!aborted)
     {
       emitWakeUpSignal();
     }
-    timer_waiting_ = false;
   });
 
   return NodeStatus::RUNNING;
@@ -38,6 +42,7 @@ NodeStatus SleepNode::onStart()
 
 NodeStatus SleepNode::onRunning()
 {
+  std::unique_lock<std::mutex> lk(delay_mutex_);
   return timer_waiting_ ? NodeStatus::RUNNING : NodeStatus::SUCCESS;
 }
 
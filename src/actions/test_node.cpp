@@ -37,6 +37,8 @@ TestNode::TestNode(const std::string& name, const NodeConfig& config,
 
 NodeStatus TestNode::onStart()
 {
+  // only the timer emits the wake-up signal
+  setWaitForEvents(_config->async_delay > std::chrono::milliseconds(0));
   if(_config->async_delay <= std::chrono::milliseconds(0))
   {
     return onCompleted();
@@ -2,6 +2,8 @@
 #include "behaviortree_cpp/tree_node.h"
 #include "behaviortree_cpp/json_export.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
 #include <clocale>
@@ -188,15 +190,49 @@ uint32_t convertFromString<uint32_t>(StringView str)
   return ConvertWithBoundCheck<uint32_t>(str);
 }
 
+namespace
+{
+// std::from_chars is locale independent and it doesn't allocate.
+// It is stricter than std::stod, therefore false is returned when the
+// string isn't entirely a number and the caller should fall back to std::stod
+template <typename T>
+bool parseFloatingPoint(StringView str, T& out)
+{
+#if __cpp_lib_to_chars >= 201611L
+  const char* first = str.data();
+  const char* last = first + str.size();
+  while(first < last && std::isspace(static_cast<unsigned char>(*first)))
+  {
+    first++;
+  }
+  if(first < last && *first == '+')
+  {
+    first++;
+  }
+  auto [ptr, ec] = std::from_chars(first, last, out);
+  return ec == std::errc() && ptr == last;
+#else
+  (void)str;
+  (void)out;
+  return false;
+#endif
+}
+}  // namespace
+
 template <>
 double convertFromString<double>(StringView str)
 {
+  double val = 0;
+  if(parseFloatingPoint(str, val))
+  {
+    return val;
+  }
   // see issue #120
   // http://quick-bench.com/DWaXRWnxtxvwIMvZy2DxVPEKJnE
 
   std::string old_locale = setlocale(LC_NUMERIC, nullptr);
   setlocale(LC_NUMERIC, "C");
-  double val = std::stod(str.data());
+  val = std::stod(str.data());
   setlocale(LC_NUMERIC, old_locale.c_str());
   return val;
 }
@@ -204,9 +240,14 @@ double convertFromString<double>(StringView str)
 template <>
 float convertFromString<float>(StringView str)
 {
+  float val = 0;
+  if(parseFloatingPoint(str, val))
+  {
+    return val;
+  }
   std::string old_locale = setlocale(LC_NUMERIC, nullptr);
   setlocale(LC_NUMERIC, "C");
-  float val = std::stof(str.data());
+  val = std::stof(str.data());
   setlocale(LC_NUMERIC, old_locale.c_str());
   return val;
 }
@@ -214,39 +255,33 @@ float convertFromString<float>(StringView str)
 template <>
 std::vector<int> convertFromString<std::vector<int>>(StringView str)
 {
-  auto parts = splitString(str, ';');
   std::vector<int> output;
-  output.reserve(parts.size());
-  for(const StringView& part : parts)
-  {
+  output.reserve(splitStringCount(str, ';'));
+  forEachSplit(str, ';', [&output](StringView part) {
     output.push_back(convertFromString<int>(part));
-  }
+  });
   return output;
 }
 
 template <>
 std::vector<double> convertFromString<std::vector<double>>(StringView str)
 {
-  auto parts = splitString(str, ';');
   std::vector<double> output;
-  output.reserve(parts.size());
-  for(const StringView& part : parts)
-  {
+  output.reserve(splitStringCount(str, ';'));
+  forEachSplit(str, ';', [&output](StringView part) {
     output.push_back(convertFromString<double>(part));
-  }
+  });
   return output;
 }
 
 template <>
 std::vector<std::string> convertFromString<std::vector<std::string>>(StringView str)
 {
-  auto parts = splitString(str, ';');
   std::vector<std::string> output;
-  output.reserve(parts.size());
-  for(const StringView& part : parts)
-  {
+  output.reserve(splitStringCount(str, ';'));
+  forEachSplit(str, ';', [&output](StringView part) {
     output.push_back(convertFromString<std::string>(part));
-  }
+  });
   return output;
 }
 
@@ -349,21 +384,21 @@ std::ostream& operator<<(std::ostream& os, const PortDirection& type)
 std::vector<StringView> splitString(const StringView& strToSplit, char delimeter)
 {
   std::vector<StringView> splitted_strings;
-  splitted_strings.reserve(4);
+  splitted_strings.reserve(splitStringCount(strToSplit, delimeter));
+  forEachSplit(strToSplit, delimeter,
+               [&](StringView part) { splitted_strings.push_back(part); });
+  return splitted_strings;
+}
 
-  size_t pos = 0;
-  while(pos < strToSplit.size())
+size_t splitStringCount(const StringView& strToSplit, char delimeter)
+{
+  if(strToSplit.empty())
   {
-    size_t new_pos = strToSplit.find_first_of(delimeter, pos);
-    if(new_pos == std::string::npos)
-    {
-      new_pos = strToSplit.size();
-    }
-    const auto sv = StringView{ &strToSplit.data()[pos], new_pos - pos };
-    splitted_strings.push_back(sv);
-    pos = new_pos + 1;
+    return 0;
   }
-  return splitted_strings;
+  const auto count = size_t(std::count(strToSplit.begin(), strToSplit.end(), delimeter));
+  // a delimiter at the end doesn't create an additional (empty) part
+  return (strToSplit.back() == delimeter) ? count : count + 1;
 }
 
 PortDirection PortInfo::direction() const
@@ -449,7 +484,7 @@ bool IsReservedAttribute(StringView str)
       return true;
     }
   }
-  return str == "name" || str == "ID" || str == "_autoremap";
+  return str == "name" || str == "ID" || str == "_autoremap" || str == "_lazy";
 }
 
 Any convertFromJSON(StringView json_text, std::type_index type)
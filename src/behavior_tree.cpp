@@ -15,100 +15,69 @@
 
 namespace BT
 {
-void applyRecursiveVisitor(const TreeNode* node,
-                           const std::function<void(const TreeNode*)>& visitor)
+namespace
+{
+// Pre-order visit that follows TreeNode::children(): no dynamic_cast, no
+// allocation and the visitor is called directly, without std::function.
+template <typename NodeT, typename Visitor>
+void VisitPreOrder(NodeT* node, const Visitor& visitor)
 {
   if(!node)
   {
     throw LogicError("One of the children of a DecoratorNode or ControlNode is nullptr");
   }
-
   visitor(node);
-
-  if(auto control = dynamic_cast<const BT::ControlNode*>(node))
-  {
-    for(const auto& child : control->children())
-    {
-      applyRecursiveVisitor(static_cast<const TreeNode*>(child), visitor);
-    }
-  }
-  else if(auto decorator = dynamic_cast<const BT::DecoratorNode*>(node))
+  for(TreeNode* child : node->children())
   {
-    applyRecursiveVisitor(decorator->child(), visitor);
+    VisitPreOrder<NodeT>(child, visitor);
   }
 }
 
-void applyRecursiveVisitor(TreeNode* node, const std::function<void(TreeNode*)>& visitor)
+void PrintNode(unsigned indent, const TreeNode* node, std::ostream& stream)
 {
-  if(!node)
+  for(unsigned i = 0; i < indent; i++)
   {
-    throw LogicError("One of the children of a DecoratorNode or ControlNode is nullptr");
+    stream << "   ";
   }
-
-  visitor(node);
-
-  if(auto control = dynamic_cast<BT::ControlNode*>(node))
+  if(!node)
   {
-    for(const auto& child : control->children())
-    {
-      applyRecursiveVisitor(child, visitor);
-    }
+    stream << "!nullptr!" << std::endl;
+    return;
   }
-  else if(auto decorator = dynamic_cast<BT::DecoratorNode*>(node))
+  stream << node->name() << std::endl;
+  for(const TreeNode* child : node->children())
   {
-    if(decorator->child())
-    {
-      applyRecursiveVisitor(decorator->child(), visitor);
-    }
+    PrintNode(indent + 1, child, stream);
   }
 }
+}  // namespace
 
-void printTreeRecursively(const TreeNode* root_node, std::ostream& stream)
+void applyRecursiveVisitor(const TreeNode* node,
+                           const std::function<void(const TreeNode*)>& visitor)
 {
-  std::function<void(unsigned, const BT::TreeNode*)> recursivePrint;
-
-  recursivePrint = [&recursivePrint, &stream](unsigned indent, const BT::TreeNode* node) {
-    for(unsigned i = 0; i < indent; i++)
-    {
-      stream << "   ";
-    }
-    if(!node)
-    {
-      stream << "!nullptr!" << std::endl;
-      return;
-    }
-    stream << node->name() << std::endl;
-    indent++;
+  VisitPreOrder<const TreeNode>(node, visitor);
+}
 
-    if(auto control = dynamic_cast<const BT::ControlNode*>(node))
-    {
-      for(const auto& child : control->children())
-      {
-        recursivePrint(indent, child);
-      }
-    }
-    else if(auto decorator = dynamic_cast<const BT::DecoratorNode*>(node))
-    {
-      recursivePrint(indent, decorator->child());
-    }
-  };
+void applyRecursiveVisitor(TreeNode* node, const std::function<void(TreeNode*)>& visitor)
+{
+  VisitPreOrder<TreeNode>(node, visitor);
+}
 
+void printTreeRecursively(const TreeNode* root_node, std::ostream& stream)
+{
   stream << "----------------" << std::endl;
-  recursivePrint(0, root_node);
+  PrintNode(0, root_node, stream);
   stream << "----------------" << std::endl;
 }
 
-void buildSerializedStatusSnapshot(TreeNode* root_node,
+void buildSerializedStatusSnapshot(const TreeNode* root_node,
                                    SerializedTreeStatus& serialized_buffer)
 {
   serialized_buffer.clear();
 
-  auto visitor = [&serialized_buffer](const TreeNode* node) {
-    serialized_buffer.push_back(
-        std::make_pair(node->UID(), static_cast<uint8_t>(node->status())));
-  };
-
-  applyRecursiveVisitor(root_node, visitor);
+  VisitPreOrder<const TreeNode>(root_node, [&serialized_buffer](const TreeNode* node) {
+    serialized_buffer.emplace_back(node->UID(), static_cast<uint8_t>(node->status()));
+  });
 }
 
 int LibraryVersionNumber()
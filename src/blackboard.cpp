@@ -1,4 +1,5 @@
 #include "behaviortree_cpp/blackboard.h"
+#include <atomic>
 #include <unordered_set>
 #include "behaviortree_cpp/json_export.h"
 
@@ -10,9 +11,36 @@ bool IsPrivateKey(StringView str)
   return str.size() >= 1 && str.data()[0] == '_';
 }
 
+namespace
+{
+std::atomic<uint64_t> structure_version{ 1 };
+std::atomic<uint64_t> write_version{ 1 };
+}
+
+Blackboard::~Blackboard()
+{
+  bumpStructureVersion();
+}
+
+uint64_t Blackboard::structureVersion()
+{
+  return structure_version.load(std::memory_order_acquire);
+}
+
+uint64_t Blackboard::writeVersion()
+{
+  return write_version.load(std::memory_order_acquire);
+}
+
+void Blackboard::bumpStructureVersion()
+{
+  structure_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
 void Blackboard::enableAutoRemapping(bool remapping)
 {
   autoremapping_ = remapping;
+  bumpStructureVersion();
 }
 
 AnyPtrLocked Blackboard::getAnyLocked(const std::string& key)
@@ -90,6 +118,67 @@ void Blackboard::addSubtreeRemapping(StringView internal, StringView external)
 {
   internal_to_external_.insert(
       { static_cast<std::string>(internal), static_cast<std::string>(external) });
+  bumpStructureVersion();
+}
+
+void Blackboard::enableMailbox(const std::string& key)
+{
+  auto entry = getEntry(key);
+  if(!entry)
+  {
+    throw RuntimeError("Blackboard::enableMailbox() error. Missing key [", key, "]");
+  }
+  auto root = rootBlackboard();
+  std::unique_lock lk(root->mailbox_mutex_);
+  if(!entry->mailbox)
+  {
+    entry->mailbox = std::make_unique<Entry::Mailbox>();
+    root->mailbox_entries_.push_back(entry);
+  }
+}
+
+void Blackboard::postImpl(const std::string& key, Entry& entry, Any&& value)
+{
+  if(!entry.mailbox)
+  {
+    throw RuntimeError("Blackboard::post() error. The entry [", key,
+                       "] is not in mailbox mode. Use enableMailbox() first");
+  }
+  // the previous value, if not committed yet, is replaced and discarded
+  auto fresh = std::make_unique<Any>(std::move(value));
+  std::unique_ptr<Any> discarded(
+      entry.mailbox->pending.exchange(fresh.release(), std::memory_order_acq_rel));
+  write_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+size_t Blackboard::commitMailboxes()
+{
+  auto root = rootBlackboard();
+  std::unique_lock lk(root->mailbox_mutex_);
+  size_t count = 0;
+  for(const auto& entry : root->mailbox_entries_)
+  {
+    std::unique_ptr<Any> posted(
+        entry->mailbox->pending.exchange(nullptr, std::memory_order_acq_rel));
+    if(!posted)
+    {
+      continue;
+    }
+    Any new_value = std::move(*posted);
+
+    std::scoped_lock entry_lock(entry->entry_mutex);
+    if(!entry->info.isStronglyTyped())
+    {
+      entry->value = std::move(new_value);
+    }
+    else
+    {
+      new_value.copyInto(entry->value);
+    }
+    entry->markUpdated();
+    count++;
+  }
+  return count;
 }
 
 void Blackboard::debugMessage() const
@@ -132,6 +221,7 @@ void Blackboard::clear()
 {
   std::unique_lock<std::mutex> lock(mutex_);
   storage_.clear();
+  bumpStructureVersion();
 }
 
 std::recursive_mutex& Blackboard::entryMutex() const
@@ -181,8 +271,7 @@ void Blackboard::cloneInto(Blackboard& dst) const
       dst_entry->string_converter = src_entry->string_converter;
       dst_entry->value = src_entry->value;
       dst_entry->info = src_entry->info;
-      dst_entry->sequence_id++;
-      dst_entry->stamp = std::chrono::steady_clock::now().time_since_epoch();
+      dst_entry->markUpdated();
     }
     else
     {
@@ -198,6 +287,7 @@ void Blackboard::cloneInto(Blackboard& dst) const
   {
     dst_storage.erase(key);
   }
+  bumpStructureVersion();
 }
 
 Blackboard::Ptr Blackboard::parent()
@@ -261,6 +351,7 @@ std::shared_ptr<Blackboard::Entry> Blackboard::createEntryImpl(const std::string
   // even if empty, let's assign to it a default type
   entry->value = Any(info.type());
   storage_.insert({ key, entry });
+  bumpStructureVersion();
   return entry;
 }
 
@@ -293,7 +384,9 @@ void ImportBlackboardFromJSON(const nlohmann::json& json, Blackboard& blackboard
         blackboard.createEntry(it.key(), res->second);
         entry = blackboard.getEntry(it.key());
       }
+      std::scoped_lock lock(entry->entry_mutex);
       entry->value = res->first;
+      entry->markUpdated();
     }
   }
 }
@@ -308,6 +401,13 @@ Blackboard::Entry& Blackboard::Entry::operator=(const Entry& other)
   return *this;
 }
 
+void Blackboard::Entry::markUpdated()
+{
+  sequence_id++;
+  stamp = std::chrono::steady_clock::now().time_since_epoch();
+  write_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
 Blackboard* BT::Blackboard::rootBlackboard()
 {
   auto bb = static_cast<const Blackboard&>(*this).rootBlackboard();
@@ -10,9 +10,19 @@
 *   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
 #include "behaviortree_cpp/bt_factory.h"
 #include "behaviortree_cpp/utils/shared_library.h"
+#include "behaviortree_cpp/utils/wildcard_index.h"
 #include "behaviortree_cpp/xml_parsing.h"
 #include "wildcards/wildcards.hpp"
 
@@ -24,6 +34,120 @@ bool WildcardMatch(std::string const& str, StringView filter)
   return wildcards::match(str, filter);
 }
 
+// The value of the attribute _period: a number followed by "us", "ms" or "s".
+// Without unit, milliseconds.
+Expected<std::chrono::microseconds> ParseTickPeriod(StringView str)
+{
+  using namespace std::chrono;
+  double scale = 1000.0;
+  if(str.size() > 2 && str.substr(str.size() - 2) == "us")
+  {
+    scale = 1.0;
+    str.remove_suffix(2);
+  }
+  else if(str.size() > 2 && str.substr(str.size() - 2) == "ms")
+  {
+    str.remove_suffix(2);
+  }
+  else if(str.size() > 1 && str.back() == 's')
+  {
+    scale = 1e6;
+    str.remove_suffix(1);
+  }
+  double value = 0;
+  try
+  {
+    value = convertFromString<double>(str);
+  }
+  catch(std::exception&)
+  {
+    return nonstd::make_unexpected("Expected a number followed by us, ms or s");
+  }
+  // half of the range of the clock, so that now() + period can't overflow
+  const double max_period =
+      double(duration_cast<microseconds>(steady_clock::duration::max()).count()) / 2;
+  if(!std::isfinite(value) || value * scale >= max_period)
+  {
+    return nonstd::make_unexpected("The period is out of range");
+  }
+  const auto period = microseconds(static_cast<int64_t>(value * scale));
+  if(period.count() <= 0)
+  {
+    return nonstd::make_unexpected("The period must be positive");
+  }
+  return period;
+}
+
+// A plugin registered with registerFromPluginManifest, that is loaded
+// the first time one of its nodes is needed.
+struct DeferredPlugin
+{
+  std::string file_path;
+  // the enums of the cache, already registered; not checked if there is no cache
+  std::optional<std::unordered_map<std::string, int>> cached_enums;
+
+  std::once_flag loaded;
+  std::atomic_bool is_loaded = false;
+  // filled by load(), immutable afterwards
+  std::unordered_map<std::string, NodeBuilder> builders;
+  std::unordered_map<std::string, TreeNodeManifest> manifests;
+  std::unordered_map<std::string, int> enums;
+
+  // thread-safe: the builders of the nodes may be copied into a TreeRegistry
+  // or into the copy of the factory used by the lazy subtrees.
+  // Return true if the plugin was loaded by this call.
+  bool load()
+  {
+    bool loaded_now = false;
+    std::call_once(loaded, [this, &loaded_now]() {
+      BehaviorTreeFactory plugin_factory;
+      plugin_factory.registerFromPlugin(file_path);
+      // the factory that registered the plugin can't change anymore
+      if(!plugin_factory.substitutionRules().empty() ||
+         !plugin_factory.registeredBehaviorTrees().empty())
+      {
+        throw RuntimeError("The plugin [", file_path,
+                           "] registers substitution rules or trees: "
+                           "use registerFromPlugin() instead of "
+                           "registerFromPluginManifest()");
+      }
+      for(const auto& [name, value] : plugin_factory.scriptingEnums())
+      {
+        if(cached_enums && (cached_enums->count(name) == 0 ||
+                            cached_enums->at(name) != value))
+        {
+          throw RuntimeError("The scripting enum [", name, "] of the plugin [",
+                             file_path, "] is not in its manifest. "
+                             "Is the manifest outdated?");
+        }
+      }
+      for(const auto& [ID, builder] : plugin_factory.builders())
+      {
+        if(plugin_factory.builtinNodes().count(ID) == 0)
+        {
+          builders.insert({ ID, builder });
+          manifests.insert({ ID, plugin_factory.manifests().at(ID) });
+        }
+      }
+      enums = plugin_factory.scriptingEnums();
+      is_loaded.store(true, std::memory_order_release);
+      loaded_now = true;
+    });
+    return loaded_now;
+  }
+
+  // nullptr if not loaded yet
+  const TreeNodeManifest* loadedManifest(const std::string& ID) const
+  {
+    if(!is_loaded.load(std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+    auto it = manifests.find(ID);
+    return (it != manifests.end()) ? &it->second : nullptr;
+  }
+};
+
 struct BehaviorTreeFactory::PImpl
 {
   std::unordered_map<std::string, NodeBuilder> builders;
@@ -33,6 +157,11 @@ struct BehaviorTreeFactory::PImpl
   std::shared_ptr<std::unordered_map<std::string, int>> scripting_enums;
   std::shared_ptr<BT::Parser> parser;
   std::unordered_map<std::string, SubstitutionRule> substitution_rules;
+  // the filters of the substitution rules. The rules have the same index
+  WildcardIndex substitution_index;
+  std::vector<SubstitutionRule> indexed_rules;
+  // nodes registered by registerFromPluginManifest(), loaded or not
+  std::unordered_map<std::string, std::shared_ptr<DeferredPlugin>> deferred_plugins;
 };
 
 BehaviorTreeFactory::BehaviorTreeFactory() : _p(new PImpl)
@@ -118,6 +247,7 @@ bool BehaviorTreeFactory::unregisterBuilder(const std::string& ID)
   }
   _p->builders.erase(ID);
   _p->manifests.erase(ID);
+  _p->deferred_plugins.erase(ID);
   return true;
 }
 
@@ -191,6 +321,103 @@ void BehaviorTreeFactory::registerFromPlugin(const std::string& file_path)
   }
 }
 
+void BehaviorTreeFactory::registerFromPluginManifest(
+    const std::string& file_path, const std::filesystem::path& manifest_path)
+{
+  std::error_code ec;
+  const auto plugin_time = std::filesystem::last_write_time(file_path, ec);
+  if(ec)
+  {
+    throw RuntimeError("Can't find the plugin: ", file_path);
+  }
+  const auto manifest_time = std::filesystem::last_write_time(manifest_path, ec);
+
+  auto plugin = std::make_shared<DeferredPlugin>();
+  plugin->file_path = file_path;
+
+  // cache missing or outdated: load the plugin now and write the cache
+  if(ec || manifest_time < plugin_time)
+  {
+    plugin->load();
+    BehaviorTreeFactory plugin_factory;
+    for(const auto& [ID, manifest] : plugin->manifests)
+    {
+      plugin_factory.registerBuilder(manifest, plugin->builders.at(ID));
+      registerBuilder(manifest, plugin->builders.at(ID));
+    }
+    for(const auto& [name, value] : plugin->enums)
+    {
+      plugin_factory.registerScriptingEnum(name, value);
+      registerScriptingEnum(name, value);
+    }
+    std::ofstream file(manifest_path);
+    file << writePluginManifestXML(plugin_factory);
+    file.close();
+    if(!file)
+    {
+      // a partial file would be read the next time: better none
+      std::filesystem::remove(manifest_path, ec);
+      throw RuntimeError("Can't write the manifests of the plugin [", file_path,
+                         "] into the file: ", manifest_path.string());
+    }
+    return;
+  }
+
+  std::ifstream file(manifest_path);
+  std::string xml_text((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  // the enums are registered now: the scripts may need them before the plugin is loaded
+  plugin->cached_enums.emplace();
+  for(const auto& [name, value] : readScriptingEnumsXML(xml_text))
+  {
+    registerScriptingEnum(name, value);
+    plugin->cached_enums->insert({ name, value });
+  }
+  // The manifests and the builders are never replaced, because trees, templates
+  // and registries may use them concurrently. Once the plugin is loaded,
+  // findManifest() returns its manifests, with the types of the ports.
+  for(const auto& manifest : readTreeNodesModelXML(xml_text))
+  {
+    const std::string ID = manifest.registration_ID;
+    NodeBuilder builder = [plugin, ID](const std::string& name,
+                                       const NodeConfig& config) {
+      plugin->load();
+      auto it = plugin->builders.find(ID);
+      if(it == plugin->builders.end())
+      {
+        throw RuntimeError("The node [", ID, "] is not registered by the plugin [",
+                           plugin->file_path, "]. Is the manifest outdated?");
+      }
+      return it->second(name, config);
+    };
+    registerBuilder(manifest, builder);
+    _p->deferred_plugins.insert({ ID, plugin });
+  }
+}
+
+bool BehaviorTreeFactory::loadDeferredPlugin(const std::string& ID) const
+{
+  auto it = _p->deferred_plugins.find(ID);
+  if(it == _p->deferred_plugins.end())
+  {
+    return false;
+  }
+  return it->second->load();
+}
+
+const TreeNodeManifest* BehaviorTreeFactory::findManifest(const std::string& ID) const
+{
+  if(auto it = _p->deferred_plugins.find(ID); it != _p->deferred_plugins.end())
+  {
+    if(auto manifest = it->second->loadedManifest(ID))
+    {
+      return manifest;
+    }
+  }
+  auto it = _p->manifests.find(ID);
+  return (it != _p->manifests.end()) ? &it->second : nullptr;
+}
+
 void BehaviorTreeFactory::registerFromROSPlugins()
 {
   throw RuntimeError("Using attribute [ros_pkg] in <include>, but this library was "
@@ -239,46 +466,45 @@ std::unique_ptr<TreeNode> BehaviorTreeFactory::instantiateTreeNode(
 
   std::unique_ptr<TreeNode> node;
 
+  // the first rule that was added wins
+  const auto& index = _p->substitution_index;
+  const size_t rule_index = std::min(
+      { index.find(name), index.find(ID), index.firstMatch(config.path) });
+
   bool substituted = false;
-  for(const auto& [filter, rule] : _p->substitution_rules)
+  if(rule_index != WildcardIndex::NONE)
   {
-    if(filter == name || filter == ID || wildcards::match(config.path, filter))
+    const auto& rule = _p->indexed_rules[rule_index];
+    // first case: the rule is simply a string with the name of the
+    // node to create instead
+    if(const auto substituted_ID = std::get_if<std::string>(&rule))
     {
-      // first case: the rule is simply a string with the name of the
-      // node to create instead
-      if(const auto substituted_ID = std::get_if<std::string>(&rule))
+      auto it_builder = _p->builders.find(*substituted_ID);
+      if(it_builder != _p->builders.end())
       {
-        auto it_builder = _p->builders.find(*substituted_ID);
-        if(it_builder != _p->builders.end())
-        {
-          auto& builder = it_builder->second;
-          node = builder(name, config);
-        }
-        else
-        {
-          throw RuntimeError("Substituted Node ID [", *substituted_ID, "] not found");
-        }
-        substituted = true;
-        break;
-      }
-      else if(const auto test_config = std::get_if<TestNodeConfig>(&rule))
-      {
-        node = std::make_unique<TestNode>(name, config,
-                                          std::make_shared<TestNodeConfig>(*test_config));
-        substituted = true;
-        break;
-      }
-      else if(const auto test_config =
-                  std::get_if<std::shared_ptr<TestNodeConfig>>(&rule))
-      {
-        node = std::make_unique<TestNode>(name, config, *test_config);
-        substituted = true;
-        break;
+        auto& builder = it_builder->second;
+        node = builder(name, config);
       }
       else
       {
-        throw LogicError("Substitution rule is not a string or a TestNodeConfig");
+        throw RuntimeError("Substituted Node ID [", *substituted_ID, "] not found");
       }
+      substituted = true;
+    }
+    else if(const auto test_config = std::get_if<TestNodeConfig>(&rule))
+    {
+      node = std::make_unique<TestNode>(name, config,
+                                        std::make_shared<TestNodeConfig>(*test_config));
+      substituted = true;
+    }
+    else if(const auto test_config = std::get_if<std::shared_ptr<TestNodeConfig>>(&rule))
+    {
+      node = std::make_unique<TestNode>(name, config, *test_config);
+      substituted = true;
+    }
+    else
+    {
+      throw LogicError("Substitution rule is not a string or a TestNodeConfig");
     }
   }
 
@@ -313,6 +539,42 @@ std::unique_ptr<TreeNode> BehaviorTreeFactory::instantiateTreeNode(
   AssignConditions(config.pre_conditions, node->preConditionsScripts());
   AssignConditions(config.post_conditions, node->postConditionsScripts());
 
+  // the node and its children are ticked at most once per period
+  auto period_it = config.other_attributes.find("_period");
+  if(period_it != config.other_attributes.end())
+  {
+    const auto period = ParseTickPeriod(period_it->second);
+    if(!period)
+    {
+      throw RuntimeError("Node [", config.path, "]: invalid attribute _period=\"",
+                         period_it->second, "\". ", period.error());
+    }
+    // ThreadedAction overrides executeTick(), where the period is handled
+    if(dynamic_cast<ThreadedAction*>(node.get()))
+    {
+      throw RuntimeError("Node [", config.path,
+                         "]: the attribute _period can not be used by a "
+                         "ThreadedAction; use it in a parent node instead");
+    }
+    node->setTickPeriod(period.value());
+  }
+
+  // the result of a condition is reused while its inputs don't change
+  auto memoize_it = config.other_attributes.find("_memoize");
+  if(memoize_it != config.other_attributes.end() &&
+     convertFromString<bool>(memoize_it->second))
+  {
+    if(auto condition = dynamic_cast<ConditionNode*>(node.get()))
+    {
+      node->setMemoizedKeys(condition->blackboardDependencies());
+    }
+    else if(!substituted)
+    {
+      throw RuntimeError("Node [", config.path,
+                         "]: the attribute _memoize can be used only by conditions");
+    }
+  }
+
   return node;
 }
 
@@ -327,6 +589,11 @@ BehaviorTreeFactory::manifests() const
   return _p->manifests;
 }
 
+const std::unordered_map<std::string, int>& BehaviorTreeFactory::scriptingEnums() const
+{
+  return *_p->scripting_enums;
+}
+
 const std::set<std::string>& BehaviorTreeFactory::builtinNodes() const
 {
   return _p->builtin_IDs;
@@ -377,6 +644,119 @@ Tree BehaviorTreeFactory::createTree(const std::string& tree_name,
   return tree;
 }
 
+TreeTemplate::Ptr BehaviorTreeFactory::compileTree(const std::string& tree_name)
+{
+  return _p->parser->compileTree(tree_name);
+}
+
+struct TreeRegistry::PImpl
+{
+  std::unique_ptr<BehaviorTreeFactory> factory;
+  std::unordered_map<std::string, TreeTemplate::Ptr> templates;
+  // trees that could not be compiled
+  std::unordered_map<std::string, std::string> errors;
+  std::vector<std::string> tree_IDs;
+};
+
+TreeRegistry::TreeRegistry() : _p(new PImpl)
+{}
+
+TreeRegistry::~TreeRegistry() = default;
+
+Tree TreeRegistry::createTree(const std::string& tree_name,
+                              Blackboard::Ptr blackboard) const
+{
+  return treeTemplate(tree_name)->instantiate(std::move(blackboard));
+}
+
+TreeTemplate::Ptr TreeRegistry::treeTemplate(const std::string& tree_name) const
+{
+  if(auto it = _p->templates.find(tree_name); it != _p->templates.end())
+  {
+    return it->second;
+  }
+  if(auto it = _p->errors.find(tree_name); it != _p->errors.end())
+  {
+    throw RuntimeError(it->second);
+  }
+  throw RuntimeError("TreeRegistry: tree [", tree_name, "] not registered");
+}
+
+std::vector<std::string> TreeRegistry::registeredBehaviorTrees() const
+{
+  return _p->tree_IDs;
+}
+
+const BehaviorTreeFactory& TreeRegistry::factory() const
+{
+  return *_p->factory;
+}
+
+TreeRegistry::Ptr BehaviorTreeFactory::compileRegistry()
+{
+  std::shared_ptr<TreeRegistry> registry(new TreeRegistry);
+
+  // compiled first, because the deferred plugins are loaded when needed
+  std::unordered_map<std::string, TreeTemplate::Ptr> templates;
+  registry->_p->tree_IDs = registeredBehaviorTrees();
+  for(const auto& tree_ID : registry->_p->tree_IDs)
+  {
+    try
+    {
+      templates[tree_ID] = compileTree(tree_ID);
+    }
+    catch(const std::exception& ex)
+    {
+      registry->_p->errors[tree_ID] = ex.what();
+    }
+  }
+
+  auto& factory = registry->_p->factory;
+  factory = cloneNodeTypes();
+  factory->_p->behavior_tree_definitions = _p->behavior_tree_definitions;
+  factory->_p->scripting_enums =
+      std::make_shared<std::unordered_map<std::string, int>>(*_p->scripting_enums);
+
+  for(const auto& [tree_ID, tree_template] : templates)
+  {
+    registry->_p->templates[tree_ID] = tree_template->rebind(*factory);
+  }
+  return registry;
+}
+
+std::unique_ptr<BehaviorTreeFactory> BehaviorTreeFactory::cloneNodeTypes() const
+{
+  auto factory = std::make_unique<BehaviorTreeFactory>();
+  factory->_p->builders = _p->builders;
+  factory->_p->manifests = _p->manifests;
+  factory->_p->builtin_IDs = _p->builtin_IDs;
+  factory->_p->scripting_enums = _p->scripting_enums;
+  factory->_p->substitution_rules = _p->substitution_rules;
+  factory->_p->substitution_index = _p->substitution_index;
+  factory->_p->indexed_rules = _p->indexed_rules;
+  factory->_p->deferred_plugins = _p->deferred_plugins;
+  return factory;
+}
+
+std::vector<std::string> BehaviorTreeFactory::reloadTree(Tree& tree,
+                                                         const std::string& xml_text)
+{
+  return _p->parser->reloadTree(tree, xml_text);
+}
+
+TreeTemplate::Ptr
+BehaviorTreeFactory::loadCompiledTreeFromFile(const std::filesystem::path& file_path)
+{
+  std::ifstream file(file_path, std::ios::binary);
+  if(!file)
+  {
+    throw RuntimeError("Can't open the file: ", file_path.string());
+  }
+  std::string buffer((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+  return TreeTemplate::deserialize(*this, buffer.data(), buffer.size());
+}
+
 void BehaviorTreeFactory::addMetadataToManifest(const std::string& node_id,
                                                 const KeyValueVector& metadata)
 {
@@ -410,16 +790,28 @@ void BehaviorTreeFactory::registerScriptingEnum(StringView name, int value)
 void BehaviorTreeFactory::clearSubstitutionRules()
 {
   _p->substitution_rules.clear();
+  _p->substitution_index.clear();
+  _p->indexed_rules.clear();
 }
 
 void BehaviorTreeFactory::addSubstitutionRule(StringView filter, SubstitutionRule rule)
 {
-  _p->substitution_rules[std::string(filter)] = rule;
+  const size_t index = _p->substitution_index.add(std::string(filter));
+  if(index == _p->indexed_rules.size())
+  {
+    _p->indexed_rules.push_back(rule);
+  }
+  else
+  {
+    _p->indexed_rules[index] = rule;
+  }
+  _p->substitution_rules[std::string(filter)] = std::move(rule);
 }
 
 void BehaviorTreeFactory::loadSubstitutionRuleFromJSON(const std::string& json_text)
 {
-  auto const json = nlohmann::json::parse(json_text);
+  // ordered: the rules have the priority of the file
+  auto const json = nlohmann::ordered_json::parse(json_text);
 
   std::unordered_map<std::string, TestNodeConfig> configs;
 
@@ -450,6 +842,10 @@ void BehaviorTreeFactory::loadSubstitutionRuleFromJSON(const std::string& json_t
   }
 
   auto substitutions = json.at("SubstitutionRules");
+  const size_t rules_count = _p->indexed_rules.size() + substitutions.size();
+  _p->substitution_index.reserve(rules_count);
+  _p->indexed_rules.reserve(rules_count);
+  _p->substitution_rules.reserve(rules_count);
   for(auto const& [node_name, test] : substitutions.items())
   {
     auto test_name = test.get<std::string>();
@@ -474,16 +870,192 @@ BehaviorTreeFactory::substitutionRules() const
 Tree::Tree()
 {}
 
+Tree::Tree(Tree&& other)
+{
+  *this = std::move(other);
+}
+
+Tree& Tree::operator=(Tree&& other)
+{
+  subtrees = std::move(other.subtrees);
+  manifests = std::move(other.manifests);
+  wake_up_ = std::move(other.wake_up_);
+  uid_counter_ = other.uid_counter_;
+  lazy_subtrees_ = std::move(other.lazy_subtrees_);
+  nodes_by_path_ = std::move(other.nodes_by_path_);
+  nodes_by_uid_ = std::move(other.nodes_by_uid_);
+  indexed_nodes_ = other.indexed_nodes_;
+  preorder_nodes_ = std::move(other.preorder_nodes_);
+  last_sources_ = other.last_sources_;
+  dirty_ = other.dirty_.load();
+  tick_statistics_ = std::move(other.tick_statistics_);
+  other.subtrees.clear();
+  other.lazy_subtrees_.clear();
+  other.nodes_by_path_.clear();
+  other.nodes_by_uid_.clear();
+  other.indexed_nodes_ = 0;
+  other.preorder_nodes_.clear();
+  // the lazy SubTrees must add their nodes to this instance
+  for(auto subtree_node : lazy_subtrees_)
+  {
+    subtree_node->tree_ = this;
+  }
+  return *this;
+}
+
 void Tree::initialize()
 {
   wake_up_ = std::make_shared<WakeUpSignal>();
+  lazy_subtrees_.clear();
   for(auto& subtree : subtrees)
   {
     for(auto& node : subtree->nodes)
     {
       node->setWakeUpInstance(wake_up_);
+      bindLazySubtree(*node);
     }
   }
+  nodes_by_path_.clear();
+  nodes_by_uid_.clear();
+  indexed_nodes_ = 0;
+  addToNodeIndex(subtrees);
+  updatePreOrderNodes();
+}
+
+void Tree::updatePreOrderNodes()
+{
+  preorder_nodes_.clear();
+  if(rootNode())
+  {
+    size_t node_count = 0;
+    for(const auto& subtree : subtrees)
+    {
+      node_count += subtree->nodes.size();
+    }
+    preorder_nodes_.reserve(node_count);
+    auto visitor = [this](TreeNode* node) { preorder_nodes_.push_back(node); };
+    BT::applyRecursiveVisitor(rootNode(), visitor);
+  }
+}
+
+const std::vector<TreeNode*>& Tree::preOrderNodes() const
+{
+  return preorder_nodes_;
+}
+
+void Tree::addToNodeIndex(const std::vector<Subtree::Ptr>& new_subtrees)
+{
+  const size_t previous_size = nodes_by_path_.size();
+  for(const auto& subtree : new_subtrees)
+  {
+    for(const auto& node : subtree->nodes)
+    {
+      nodes_by_path_.push_back({ node->fullPath(), node.get(), indexed_nodes_++ });
+      if(node->UID() >= nodes_by_uid_.size())
+      {
+        nodes_by_uid_.resize(size_t(node->UID()) + 1, nullptr);
+      }
+      nodes_by_uid_[node->UID()] = node.get();
+    }
+  }
+  // nodes with the same path are sorted like Tree::subtrees
+  auto by_path = [](const PathEntry& a, const PathEntry& b) {
+    return std::tie(a.path, a.order) < std::tie(b.path, b.order);
+  };
+  std::sort(nodes_by_path_.begin() + long(previous_size), nodes_by_path_.end(), by_path);
+  std::inplace_merge(nodes_by_path_.begin(), nodes_by_path_.begin() + long(previous_size),
+                     nodes_by_path_.end(), by_path);
+}
+
+std::vector<TreeNode*> Tree::findNodesByPath(StringView wildcard_filter) const
+{
+  const std::string filter(wildcard_filter);
+  const size_t prefix_length = WildcardIndex::literalPrefixLength(filter);
+  const StringView prefix(filter.data(), prefix_length);
+  const bool match_all = (prefix_length + 1 == filter.size() && filter.back() == '*');
+
+  std::vector<const PathEntry*> entries;
+  auto it = std::lower_bound(
+      nodes_by_path_.begin(), nodes_by_path_.end(), prefix,
+      [](const PathEntry& entry, StringView value) { return entry.path < value; });
+  for(; it != nodes_by_path_.end() && it->path.substr(0, prefix_length) == prefix; ++it)
+  {
+    if(prefix_length == filter.size())
+    {
+      // no wildcard: all the nodes with this path (the names may be repeated)
+      if(it->path != prefix)
+      {
+        break;
+      }
+      entries.push_back(&(*it));
+      continue;
+    }
+    if(match_all || wildcards::match(it->path, filter))
+    {
+      entries.push_back(&(*it));
+    }
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const PathEntry* a, const PathEntry* b) { return a->order < b->order; });
+
+  std::vector<TreeNode*> nodes;
+  nodes.reserve(entries.size());
+  for(const auto entry : entries)
+  {
+    nodes.push_back(entry->node);
+  }
+  return nodes;
+}
+
+TreeNode* Tree::getNodeByPath(StringView path) const
+{
+  auto it = std::lower_bound(
+      nodes_by_path_.begin(), nodes_by_path_.end(), path,
+      [](const PathEntry& entry, StringView value) { return entry.path < value; });
+  return (it != nodes_by_path_.end() && it->path == path) ? it->node : nullptr;
+}
+
+TreeNode* Tree::getNodeByUID(uint16_t uid) const
+{
+  return (uid < nodes_by_uid_.size()) ? nodes_by_uid_[uid] : nullptr;
+}
+
+void Tree::bindLazySubtree(TreeNode& node)
+{
+  if(node.type() == NodeType::SUBTREE)
+  {
+    auto subtree_node = dynamic_cast<SubTreeNode*>(&node);
+    if(subtree_node && subtree_node->isLazy())
+    {
+      subtree_node->tree_ = this;
+      lazy_subtrees_.push_back(subtree_node);
+    }
+  }
+}
+
+void Tree::instantiateLazySubtrees()
+{
+  // the list changes while the subtrees are created
+  while(!lazy_subtrees_.empty())
+  {
+    lazy_subtrees_.back()->instantiateSubtree();
+  }
+}
+
+void Tree::addLazySubtrees(SubTreeNode& node, std::vector<Subtree::Ptr> new_subtrees)
+{
+  lazy_subtrees_.erase(std::find(lazy_subtrees_.begin(), lazy_subtrees_.end(), &node));
+  addToNodeIndex(new_subtrees);
+  for(auto& subtree : new_subtrees)
+  {
+    for(auto& new_node : subtree->nodes)
+    {
+      new_node->setWakeUpInstance(wake_up_);
+      bindLazySubtree(*new_node);
+    }
+    subtrees.push_back(std::move(subtree));
+  }
+  updatePreOrderNodes();
 }
 
 void Tree::haltTree()
@@ -497,8 +1069,7 @@ void Tree::haltTree()
   rootNode()->haltNode();
 
   //but, just in case.... this should be no-op
-  auto visitor = [](BT::TreeNode* node) { node->haltNode(); };
-  BT::applyRecursiveVisitor(rootNode(), visitor);
+  applyVisitor([](BT::TreeNode* node) { node->haltNode(); });
 
   rootNode()->resetStatus();
 }
@@ -516,7 +1087,7 @@ TreeNode* Tree::rootNode() const
 bool Tree::sleep(std::chrono::system_clock::duration timeout)
 {
   return wake_up_->waitFor(
-      std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+      std::chrono::duration_cast<std::chrono::microseconds>(timeout));
 }
 
 Tree::~Tree()
@@ -534,11 +1105,119 @@ NodeStatus Tree::tickOnce()
   return tickRoot(ONCE_UNLESS_WOKEN_UP, std::chrono::milliseconds(0));
 }
 
+NodeStatus Tree::tickOnceIfNeeded()
+{
+  auto root = rootNode();
+  if(wake_up_ && root && root->status() == NodeStatus::RUNNING && !dirty_ &&
+     !wake_up_->polling_requested)
+  {
+    const ChangeSources sources = { Blackboard::writeVersion(),
+                                    Blackboard::structureVersion(),
+                                    wake_up_->emittedCount() };
+    if(sources == last_sources_ &&
+       std::chrono::steady_clock::now() < wake_up_->next_deadline)
+    {
+      return NodeStatus::RUNNING;
+    }
+  }
+  return tickOnce();
+}
+
+void Tree::markDirty()
+{
+  dirty_ = true;
+}
+
+void Tree::recordChangeSources()
+{
+  // before the tick: what happens during the tick is considered a change,
+  // for instance an output written by a node
+  dirty_ = false;
+  last_sources_ = { Blackboard::writeVersion(), Blackboard::structureVersion(),
+                    wake_up_->emittedCount() };
+  wake_up_->polling_requested = false;
+  wake_up_->next_deadline = std::chrono::steady_clock::time_point::max();
+}
+
 NodeStatus Tree::tickWhileRunning(std::chrono::milliseconds sleep_time)
 {
   return tickRoot(WHILE_RUNNING, sleep_time);
 }
 
+NodeStatus Tree::tickAtFixedRate(const FixedRateOptions& options)
+{
+  using namespace std::chrono;
+  using Clock = steady_clock;
+
+  if(options.period.count() <= 0)
+  {
+    throw RuntimeError("tickAtFixedRate: the period must be positive");
+  }
+  if(options.overrun_policy == OverrunPolicy::USE_CALLBACK && !options.on_overrun)
+  {
+    throw RuntimeError("tickAtFixedRate: OverrunPolicy::USE_CALLBACK requires "
+                       "on_overrun");
+  }
+  const auto period = duration_cast<Clock::duration>(options.period);
+  const auto budget = options.budget.count() > 0 ? options.budget : options.period;
+  tick_statistics_ = TickStatistics(options.statistics_window);
+
+  auto deadline = Clock::now();
+  NodeStatus status = NodeStatus::IDLE;
+  do
+  {
+    const auto start = Clock::now();
+    if(tick_statistics_.tickCount() > 0)
+    {
+      // compared with the deadline, the periods skipped before it are not jitter
+      tick_statistics_.addJitter(duration_cast<microseconds>(start - deadline));
+    }
+
+    status = tickOnce();
+
+    const auto end = Clock::now();
+    const auto duration = duration_cast<microseconds>(end - start);
+    deadline += period;
+    uint64_t missed = 0;
+    if(end > deadline)
+    {
+      // skip the periods that are already over, without drifting
+      missed = uint64_t((end - deadline) / period) + 1;
+      deadline += period * missed;
+    }
+    const bool overrun = duration > budget;
+    tick_statistics_.addTick(duration, overrun);
+    tick_statistics_.addMissedDeadlines(missed);
+
+    if((overrun || missed > 0) && options.overrun_policy != OverrunPolicy::SKIP)
+    {
+      const TickOverrun info = { duration, budget, missed };
+      if(options.overrun_policy == OverrunPolicy::USE_CALLBACK)
+      {
+        options.on_overrun(info);
+      }
+      else
+      {
+        std::cerr << "Tick overrun: " << duration.count() << " usec, budget "
+                  << budget.count() << " usec, missed deadlines: " << missed
+                  << std::endl;
+      }
+    }
+
+    if(status == NodeStatus::RUNNING)
+    {
+      std::this_thread::sleep_until(deadline);
+    }
+  } while(status == NodeStatus::RUNNING);
+
+  return status;
+}
+
+const TickStatistics& Tree::tickStatistics() const
+{
+  return tick_statistics_;
+}
+
 Blackboard::Ptr Tree::rootBlackboard()
 {
   if(subtrees.size() > 0)
@@ -550,12 +1229,30 @@ Blackboard::Ptr Tree::rootBlackboard()
 
 void Tree::applyVisitor(const std::function<void(const TreeNode*)>& visitor) const
 {
-  BT::applyRecursiveVisitor(static_cast<const TreeNode*>(rootNode()), visitor);
+  // not initialized yet
+  if(preorder_nodes_.empty())
+  {
+    BT::applyRecursiveVisitor(static_cast<const TreeNode*>(rootNode()), visitor);
+    return;
+  }
+  for(const TreeNode* node : preorder_nodes_)
+  {
+    visitor(node);
+  }
 }
 
 void Tree::applyVisitor(const std::function<void(TreeNode*)>& visitor)
 {
-  BT::applyRecursiveVisitor(static_cast<TreeNode*>(rootNode()), visitor);
+  if(preorder_nodes_.empty())
+  {
+    BT::applyRecursiveVisitor(static_cast<TreeNode*>(rootNode()), visitor);
+    return;
+  }
+  // by index: the visitor may create a lazy SubTree, that updates the list
+  for(size_t i = 0; i < preorder_nodes_.size(); i++)
+  {
+    visitor(preorder_nodes_[i]);
+  }
 }
 
 uint16_t Tree::getUID()
@@ -581,6 +1278,14 @@ NodeStatus Tree::tickRoot(TickOption opt, std::chrono::milliseconds sleep_time)
   while(status == NodeStatus::IDLE ||
         (opt == TickOption::WHILE_RUNNING && status == NodeStatus::RUNNING))
   {
+    // values posted by asynchronous producers become visible here and
+    // they will not change until the next tick
+    if(auto root_bb = rootBlackboard())
+    {
+      root_bb->commitMailboxes();
+    }
+
+    recordChangeSources();
     status = rootNode()->executeTick();
 
     // Inner loop. The previous tick might have triggered the wake-up
@@ -588,6 +1293,7 @@ NodeStatus Tree::tickRoot(TickOption opt, std::chrono::milliseconds sleep_time)
     while(opt != TickOption::EXACTLY_ONCE && status == NodeStatus::RUNNING &&
           wake_up_->waitFor(std::chrono::milliseconds(0)))
     {
+      recordChangeSources();
       status = rootNode()->executeTick();
     }
 
@@ -597,7 +1303,17 @@ NodeStatus Tree::tickRoot(TickOption opt, std::chrono::milliseconds sleep_time)
     }
     if(status == NodeStatus::RUNNING && sleep_time.count() > 0)
     {
-      sleep(std::chrono::milliseconds(sleep_time));
+      // wake up in time for the node with the attribute _period due first
+      auto sleep_duration = std::chrono::steady_clock::duration(sleep_time);
+      if(wake_up_->next_deadline != std::chrono::steady_clock::time_point::max())
+      {
+        sleep_duration = std::min(
+            sleep_duration, wake_up_->next_deadline - std::chrono::steady_clock::now());
+      }
+      if(sleep_duration.count() > 0)
+      {
+        sleep(sleep_duration);
+      }
     }
   }
 
@@ -19,6 +19,35 @@ ConditionNode::ConditionNode(const std::string& name, const NodeConfig& config)
   : LeafNode::LeafNode(name, config)
 {}
 
+std::vector<std::string> ConditionNode::blackboardDependencies() const
+{
+  std::vector<std::string> keys;
+  for(const auto& [port_name, value] : config().input_ports)
+  {
+    if(auto key = getRemappedKey(port_name, value))
+    {
+      keys.emplace_back(key.value());
+    }
+  }
+  // default values of the ports missing in the XML
+  if(config().manifest)
+  {
+    for(const auto& [port_name, port_info] : config().manifest->ports)
+    {
+      const auto& default_value = port_info.defaultValueString();
+      if(port_info.direction() != PortDirection::OUTPUT &&
+         config().input_ports.count(port_name) == 0 && !default_value.empty())
+      {
+        if(auto key = getRemappedKey(port_name, default_value))
+        {
+          keys.emplace_back(key.value());
+        }
+      }
+    }
+  }
+  return keys;
+}
+
 SimpleConditionNode::SimpleConditionNode(const std::string& name,
                                          TickFunctor tick_functor,
                                          const NodeConfig& config)
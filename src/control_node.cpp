@@ -15,13 +15,55 @@
 
 namespace BT
 {
+namespace
+{
+// index of the lowest bit set; bits must not be 0
+unsigned LowestBit(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return unsigned(__builtin_ctzll(bits));
+#else
+  unsigned index = 0;
+  while((bits & 1) == 0)
+  {
+    bits >>= 1;
+    index++;
+  }
+  return index;
+#endif
+}
+}  // namespace
+
 ControlNode::ControlNode(const std::string& name, const NodeConfig& config)
   : TreeNode::TreeNode(name, config)
-{}
+{
+  setChildrenType(NodeType::CONTROL);
+}
 
 void ControlNode::addChild(TreeNode* child)
 {
   children_nodes_.push_back(child);
+
+  const size_t index = children_nodes_.size() - 1;
+  size_t first = index;
+  if(index / 64 >= active_words_)
+  {
+    // grow the bitset; all the children must use the new words
+    const size_t words_count = active_words_ + 1;
+    active_children_.reset(new std::atomic<uint64_t>[words_count]);
+    for(size_t w = 0; w < words_count; w++)
+    {
+      active_children_[w] = 0;
+    }
+    active_words_ = words_count;
+    first = 0;
+  }
+  for(size_t i = first; i <= index; i++)
+  {
+    std::shared_ptr<std::atomic<uint64_t>> word(active_children_,
+                                                &active_children_[i / 64]);
+    children_nodes_[i]->setActiveFlag(std::move(word), uint64_t(1) << (i % 64));
+  }
 }
 
 size_t ControlNode::childrenCount() const
@@ -37,16 +79,33 @@ void ControlNode::halt()
 
 void ControlNode::resetChildren()
 {
-  for(auto child : children_nodes_)
+  haltActiveChildren(children_nodes_.size());
+}
+
+void ControlNode::haltActiveChildren(size_t skip_index)
+{
+  for(size_t w = 0; w < active_words_; w++)
   {
-    if(child->status() == NodeStatus::RUNNING)
+    // haltChild() clears the bits of the word, not of this copy
+    uint64_t bits = active_children_[w].load(std::memory_order_relaxed);
+    while(bits != 0)
     {
-      child->haltNode();
+      const size_t i = w * 64 + LowestBit(bits);
+      bits &= bits - 1;
+      if(i != skip_index)
+      {
+        haltChild(i);
+      }
     }
-    child->resetStatus();
   }
 }
 
+bool ControlNode::isChildActive(size_t i) const
+{
+  const uint64_t word = active_children_[i / 64].load(std::memory_order_relaxed);
+  return (word & (uint64_t(1) << (i % 64))) != 0;
+}
+
 const std::vector<TreeNode*>& ControlNode::children() const
 {
   return children_nodes_;
@@ -54,6 +113,10 @@ const std::vector<TreeNode*>& ControlNode::children() const
 
 void ControlNode::haltChild(size_t i)
 {
+  if(!isChildActive(i))
+  {
+    return;
+  }
   auto child = children_nodes_[i];
   if(child->status() == NodeStatus::RUNNING)
   {
@@ -64,10 +127,12 @@ void ControlNode::haltChild(size_t i)
 
 void ControlNode::haltChildren()
 {
-  for(size_t i = 0; i < children_nodes_.size(); i++)
-  {
-    haltChild(i);
-  }
+  haltActiveChildren(children_nodes_.size());
+}
+
+void ControlNode::haltOtherChildren(size_t index)
+{
+  haltActiveChildren(index);
 }
 
 void ControlNode::haltChildren(size_t first)
@@ -44,13 +44,7 @@ NodeStatus ReactiveFallback::tick()
       case NodeStatus::RUNNING: {
         // reset the previous children, to make sure that they are
         // in IDLE state the next time we tick them
-        for(size_t i = 0; i < childrenCount(); i++)
-        {
-          if(i != index)
-          {
-            haltChild(i);
-          }
-        }
+        haltOtherChildren(index);
         if(running_child_ == -1)
         {
           running_child_ = int(index);
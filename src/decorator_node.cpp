@@ -17,7 +17,9 @@ namespace BT
 {
 DecoratorNode::DecoratorNode(const std::string& name, const NodeConfig& config)
   : TreeNode::TreeNode(name, config), child_node_(nullptr)
-{}
+{
+  setChildrenType(NodeType::DECORATOR);
+}
 
 void DecoratorNode::setChild(TreeNode* child)
 {
@@ -12,6 +12,8 @@ DelayNode::DelayNode(const std::string& name, unsigned milliseconds)
   , msec_(milliseconds)
   , read_parameter_from_ports_(false)
 {
+  // the timer emits the wake-up signal
+  setWaitForEvents(true);
   setRegistrationID("Delay");
 }
 
@@ -21,7 +23,9 @@ DelayNode::DelayNode(const std::string& name, const NodeConfig& config)
   , delay_aborted_(false)
   , msec_(0)
   , read_parameter_from_ports_(true)
-{}
+{
+  setWaitForEvents(true);
+}
 
 void DelayNode::halt()
 {
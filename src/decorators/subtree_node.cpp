@@ -1,4 +1,5 @@
 #include "behaviortree_cpp/decorators/subtree_node.h"
+#include "behaviortree_cpp/bt_factory.h"
 
 BT::SubTreeNode::SubTreeNode(const std::string& name, const NodeConfig& config)
   : DecoratorNode(name, config)
@@ -19,6 +20,10 @@ BT::PortsList BT::SubTreeNode::providedPorts()
 
 BT::NodeStatus BT::SubTreeNode::tick()
 {
+  if(lazy_builder_)
+  {
+    instantiateSubtree();
+  }
   NodeStatus prev_status = status();
   if(prev_status == NodeStatus::IDLE)
   {
@@ -32,3 +37,31 @@ BT::NodeStatus BT::SubTreeNode::tick()
 
   return child_status;
 }
+
+void BT::SubTreeNode::instantiateSubtree()
+{
+  if(!lazy_builder_)
+  {
+    return;
+  }
+  if(!tree_)
+  {
+    throw RuntimeError("The lazy SubTree [", fullPath(), "] doesn't belong to a Tree");
+  }
+  auto builder = std::move(lazy_builder_);
+  lazy_builder_ = nullptr;
+
+  Tree subtree;
+  try
+  {
+    builder(*this, subtree);
+  }
+  catch(...)
+  {
+    // the nodes created so far are destroyed with "subtree": it can be tried again
+    child_node_ = nullptr;
+    lazy_builder_ = std::move(builder);
+    throw;
+  }
+  tree_->addLazySubtrees(*this, std::move(subtree.subtrees));
+}
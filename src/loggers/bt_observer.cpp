@@ -1,45 +1,19 @@
 #include "behaviortree_cpp/loggers/bt_observer.h"
-#include "behaviortree_cpp/decorator_node.h"
-#include "behaviortree_cpp/control_node.h"
 
 namespace BT
 {
 TreeObserver::TreeObserver(const BT::Tree& tree) : StatusChangeLogger(tree.rootNode())
 {
-  std::function<void(const TreeNode&)> recursiveStep;
-
-  recursiveStep = [&](const TreeNode& node) {
-    if(auto control = dynamic_cast<const ControlNode*>(&node))
-    {
-      for(const auto& child : control->children())
-      {
-        recursiveStep(*child);
-      }
-    }
-    else if(auto decorator = dynamic_cast<const DecoratorNode*>(&node))
-    {
-      if(decorator->type() != NodeType::SUBTREE)
-      {
-        recursiveStep(*decorator->child());
-      }
-    }
-
-    if(_path_to_uid.count(node.fullPath()) != 0)
+  // all the nodes, from the index of the tree
+  for(const TreeNode* node : tree.findNodesByPath("*"))
+  {
+    if(_path_to_uid.count(node->fullPath()) != 0)
     {
       throw LogicError("TreeObserver not built correctly. Report issue");
     }
-    _path_to_uid[node.fullPath()] = node.UID();
-  };
-
-  for(const auto& subtree : tree.subtrees)
-  {
-    recursiveStep(*subtree->nodes.front());
-  }
-
-  for(const auto& [path, uid] : _path_to_uid)
-  {
-    _statistics[uid] = {};
-    _uid_to_path[uid] = path;
+    _path_to_uid[node->fullPath()] = node->UID();
+    _statistics[node->UID()] = {};
+    _uid_to_path[node->UID()] = node->fullPath();
   }
 }
 
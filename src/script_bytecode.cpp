@@ -0,0 +1,616 @@
+#include "behaviortree_cpp/scripting/script_bytecode.hpp"
+#include "behaviortree_cpp/scripting/operators.hpp"
+
+namespace BT::Ast
+{
+
+namespace
+{
+// Same as Any::cast<int64_t>() from a double, without exceptions
+bool ToInteger(double value, int64_t& out)
+{
+  if(value > static_cast<double>(std::numeric_limits<int64_t>::max()) ||
+     value < static_cast<double>(std::numeric_limits<int64_t>::lowest()) ||
+     value != std::nearbyint(value))
+  {
+    return false;
+  }
+  out = static_cast<int64_t>(value);
+  return true;
+}
+
+inline double FromBool(bool value)
+{
+  return value ? 1.0 : 0.0;
+}
+
+// Operators with one or two operands, shared by the interpreter and the
+// constant folding. Return false if the AST would throw an error or if
+// the result depends on the original type of the operands.
+inline bool ApplyOperator(ScriptBytecode::OpCode op, double lv, double rv, double& out)
+{
+  using OpCode = ScriptBytecode::OpCode;
+  switch(op)
+  {
+    case OpCode::NEGATE:
+      out = -lv;
+      return true;
+
+    case OpCode::COMPLEMENT:
+      if(lv > static_cast<double>(std::numeric_limits<int64_t>::max()) ||
+         lv < static_cast<double>(std::numeric_limits<int64_t>::min()))
+      {
+        return false;
+      }
+      out = static_cast<double>(~static_cast<int64_t>(lv));
+      return true;
+
+    case OpCode::LOGICAL_NOT:
+      out = FromBool(!static_cast<bool>(lv));
+      return true;
+
+    case OpCode::ADD:
+      out = lv + rv;
+      return true;
+    case OpCode::SUB:
+      out = lv - rv;
+      return true;
+    case OpCode::MUL:
+      out = lv * rv;
+      return true;
+    case OpCode::DIV:
+      out = lv / rv;
+      return true;
+
+    case OpCode::BIT_AND:
+    case OpCode::BIT_OR:
+    case OpCode::BIT_XOR: {
+      int64_t li = 0;
+      int64_t ri = 0;
+      if(!ToInteger(lv, li) || !ToInteger(rv, ri))
+      {
+        return false;
+      }
+      const int64_t res = (op == OpCode::BIT_AND) ? (li & ri) :
+                          (op == OpCode::BIT_OR)  ? (li | ri) :
+                                                    (li ^ ri);
+      out = static_cast<double>(res);
+      return true;
+    }
+
+    // Any::cast<bool>() accepts any double, but only 0 and 1 if
+    // the value was an integer. Let the AST deal with the other cases.
+    case OpCode::LOGIC_AND:
+    case OpCode::LOGIC_OR:
+      if((lv != 0.0 && lv != 1.0) || (rv != 0.0 && rv != 1.0))
+      {
+        return false;
+      }
+      out = FromBool(op == OpCode::LOGIC_AND ? (lv == 1.0 && rv == 1.0) :
+                                               (lv == 1.0 || rv == 1.0));
+      return true;
+
+    // same semantic of ExprComparison
+    case OpCode::EQUAL:
+      out = FromBool(IsSame(lv, rv));
+      return true;
+    case OpCode::NOT_EQUAL:
+      out = FromBool(!IsSame(lv, rv));
+      return true;
+    case OpCode::LESS:
+      out = FromBool(!(lv >= rv));
+      return true;
+    case OpCode::GREATER:
+      out = FromBool(!(lv <= rv));
+      return true;
+    case OpCode::LESS_EQUAL:
+      out = FromBool(!(lv > rv));
+      return true;
+    case OpCode::GREATER_EQUAL:
+      out = FromBool(!(lv < rv));
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// true if the result of evaluate() is always Any(double),
+// when the expression is evaluated successfully
+bool ProducesDouble(const ExprBase* expr)
+{
+  if(dynamic_cast<const ExprUnaryArithmetic*>(expr) ||
+     dynamic_cast<const ExprComparison*>(expr))
+  {
+    return true;
+  }
+  if(auto binary = dynamic_cast<const ExprBinaryArithmetic*>(expr))
+  {
+    return binary->op != ExprBinaryArithmetic::concat;
+  }
+  if(auto if_expr = dynamic_cast<const ExprIf*>(expr))
+  {
+    return ProducesDouble(if_expr->then.get()) && ProducesDouble(if_expr->else_.get());
+  }
+  return false;
+}
+}  // namespace
+
+class BytecodeCompiler
+{
+public:
+  using OpCode = ScriptBytecode::OpCode;
+
+  // The value of a subexpression: either known at compile time or
+  // stored in a register
+  struct Operand
+  {
+    bool is_constant = false;
+    double value = 0;
+    uint16_t reg = 0;
+  };
+
+  BytecodeCompiler(ScriptBytecode& program, const EnumsTable* enums)
+    : program_(program), enums_(enums)
+  {}
+
+  // return false if the expression can't be compiled
+  bool compile(const ExprBase* expr, Operand& out)
+  {
+    if(auto literal = dynamic_cast<const ExprLiteral*>(expr))
+    {
+      out.is_constant = true;
+      return literal->value.tryCastNumber(out.value);
+    }
+    if(auto name = dynamic_cast<const ExprName*>(expr))
+    {
+      // enums are resolved here, once and for all
+      if(enums_)
+      {
+        auto it = enums_->find(name->name);
+        if(it != enums_->end())
+        {
+          out.is_constant = true;
+          out.value = double(it->second);
+          return true;
+        }
+      }
+      out.is_constant = false;
+      return newRegister(out.reg) &&
+             emit(OpCode::LOAD_VAR, out.reg, addVariable(name->name));
+    }
+    if(auto unary = dynamic_cast<const ExprUnaryArithmetic*>(expr))
+    {
+      Operand rhs;
+      if(!compile(unary->rhs.get(), rhs))
+      {
+        return false;
+      }
+      switch(unary->op)
+      {
+        case ExprUnaryArithmetic::negate:
+          return emitOperator(OpCode::NEGATE, rhs, rhs, out);
+        case ExprUnaryArithmetic::complement:
+          return emitOperator(OpCode::COMPLEMENT, rhs, rhs, out);
+        case ExprUnaryArithmetic::logical_not:
+          return emitOperator(OpCode::LOGICAL_NOT, rhs, rhs, out);
+      }
+      return false;
+    }
+    if(auto binary = dynamic_cast<const ExprBinaryArithmetic*>(expr))
+    {
+      if(binary->op == ExprBinaryArithmetic::concat)
+      {
+        return false;
+      }
+      Operand lhs;
+      Operand rhs;
+      return compile(binary->lhs.get(), lhs) && compile(binary->rhs.get(), rhs) &&
+             emitOperator(binaryOpCode(binary->op), lhs, rhs, out);
+    }
+    if(auto comparison = dynamic_cast<const ExprComparison*>(expr))
+    {
+      return compileComparison(*comparison, out);
+    }
+    if(auto if_expr = dynamic_cast<const ExprIf*>(expr))
+    {
+      return compileIf(*if_expr, out);
+    }
+    // assignments are compiled only at the top level, see ScriptBytecode::compile
+    return false;
+  }
+
+  // make sure that the operand is stored in a register
+  bool toRegister(Operand& operand)
+  {
+    if(!operand.is_constant)
+    {
+      return true;
+    }
+    if(!newRegister(operand.reg) ||
+       !emit(OpCode::LOAD_CONST, operand.reg, addConstant(operand.value)))
+    {
+      return false;
+    }
+    operand.is_constant = false;
+    return true;
+  }
+
+  uint16_t addVariable(const std::string& name)
+  {
+    for(size_t i = 0; i < program_.names_.size(); i++)
+    {
+      if(program_.names_[i] == name)
+      {
+        return uint16_t(i);
+      }
+    }
+    program_.names_.push_back(name);
+    return uint16_t(program_.names_.size() - 1);
+  }
+
+private:
+  ScriptBytecode& program_;
+  const EnumsTable* enums_;
+  uint16_t registers_count_ = 0;
+
+  static OpCode binaryOpCode(ExprBinaryArithmetic::op_t op)
+  {
+    switch(op)
+    {
+      case ExprBinaryArithmetic::plus:
+        return OpCode::ADD;
+      case ExprBinaryArithmetic::minus:
+        return OpCode::SUB;
+      case ExprBinaryArithmetic::times:
+        return OpCode::MUL;
+      case ExprBinaryArithmetic::div:
+        return OpCode::DIV;
+      case ExprBinaryArithmetic::bit_and:
+        return OpCode::BIT_AND;
+      case ExprBinaryArithmetic::bit_or:
+        return OpCode::BIT_OR;
+      case ExprBinaryArithmetic::bit_xor:
+        return OpCode::BIT_XOR;
+      case ExprBinaryArithmetic::logic_and:
+        return OpCode::LOGIC_AND;
+      case ExprBinaryArithmetic::logic_or:
+        return OpCode::LOGIC_OR;
+      case ExprBinaryArithmetic::concat:
+        break;
+    }
+    throw LogicError("BytecodeCompiler: unexpected operator");
+  }
+
+  static OpCode comparisonOpCode(ExprComparison::op_t op)
+  {
+    switch(op)
+    {
+      case ExprComparison::equal:
+        return OpCode::EQUAL;
+      case ExprComparison::not_equal:
+        return OpCode::NOT_EQUAL;
+      case ExprComparison::less:
+        return OpCode::LESS;
+      case ExprComparison::greater:
+        return OpCode::GREATER;
+      case ExprComparison::less_equal:
+        return OpCode::LESS_EQUAL;
+      case ExprComparison::greater_equal:
+        return OpCode::GREATER_EQUAL;
+    }
+    throw LogicError("BytecodeCompiler: unexpected operator");
+  }
+
+  // If all the operands are constant, the operation is done now (constant folding)
+  bool emitOperator(OpCode op, Operand lhs, Operand rhs, Operand& out)
+  {
+    if(lhs.is_constant && rhs.is_constant &&
+       ApplyOperator(op, lhs.value, rhs.value, out.value))
+    {
+      out.is_constant = true;
+      return true;
+    }
+    out.is_constant = false;
+    return toRegister(lhs) && toRegister(rhs) && newRegister(out.reg) &&
+           emit(op, out.reg, lhs.reg, rhs.reg);
+  }
+
+  // Chained comparison, such as "A < B < C".
+  // As in ExprComparison::evaluate, the evaluation stops at the first false comparison.
+  bool compileComparison(const ExprComparison& comparison, Operand& out)
+  {
+    if(comparison.operands.size() != comparison.ops.size() + 1)
+    {
+      return false;
+    }
+    std::vector<Operand> operands(comparison.operands.size());
+    bool all_constant = true;
+    for(size_t i = 0; i < operands.size(); i++)
+    {
+      if(!compile(comparison.operands[i].get(), operands[i]))
+      {
+        return false;
+      }
+      all_constant = all_constant && operands[i].is_constant;
+    }
+    if(operands.size() == 2 || all_constant)
+    {
+      if(emitOperator(comparisonOpCode(comparison.ops[0]), operands[0], operands[1], out))
+      {
+        if(operands.size() == 2 || !out.is_constant || out.value == 0.0)
+        {
+          return true;
+        }
+        // fold the rest of the chain
+        for(size_t i = 1; i < comparison.ops.size() && out.value != 0.0; i++)
+        {
+          ApplyOperator(comparisonOpCode(comparison.ops[i]), operands[i].value,
+                        operands[i + 1].value, out.value);
+        }
+        return true;
+      }
+      return false;
+    }
+
+    // Note: all the operands were compiled before the first comparison, but
+    // the evaluation of an operand has no side effects, if not failing.
+    // Failing later, as the AST does, would give the same result.
+    out.is_constant = false;
+    if(!newRegister(out.reg))
+    {
+      return false;
+    }
+    std::vector<size_t> jumps_to_end;
+    for(size_t i = 0; i < comparison.ops.size(); i++)
+    {
+      if(!toRegister(operands[i]) || !toRegister(operands[i + 1]) ||
+         !emit(comparisonOpCode(comparison.ops[i]), out.reg, operands[i].reg,
+               operands[i + 1].reg))
+      {
+        return false;
+      }
+      if(i + 1 < comparison.ops.size())
+      {
+        jumps_to_end.push_back(program_.code_.size());
+        if(!emit(OpCode::JUMP_IF_FALSE, 0, out.reg))
+        {
+          return false;
+        }
+      }
+    }
+    for(auto index : jumps_to_end)
+    {
+      program_.code_[index].b = uint16_t(program_.code_.size());
+    }
+    return true;
+  }
+
+  bool compileIf(const ExprIf& if_expr, Operand& out)
+  {
+    Operand condition;
+    if(!compile(if_expr.condition.get(), condition))
+    {
+      return false;
+    }
+    // only one of the branches is compiled
+    if(condition.is_constant)
+    {
+      return compile(condition.value != 0.0 ? if_expr.then.get() : if_expr.else_.get(),
+                     out);
+    }
+    out.is_constant = false;
+    if(!newRegister(out.reg))
+    {
+      return false;
+    }
+    const size_t jump_to_else = program_.code_.size();
+    Operand then_value;
+    if(!emit(OpCode::JUMP_IF_FALSE, 0, condition.reg) ||
+       !compile(if_expr.then.get(), then_value) || !toRegister(then_value) ||
+       !emit(OpCode::MOVE, out.reg, then_value.reg))
+    {
+      return false;
+    }
+    const size_t jump_to_end = program_.code_.size();
+    if(!emit(OpCode::JUMP))
+    {
+      return false;
+    }
+    program_.code_[jump_to_else].b = uint16_t(program_.code_.size());
+    Operand else_value;
+    if(!compile(if_expr.else_.get(), else_value) || !toRegister(else_value) ||
+       !emit(OpCode::MOVE, out.reg, else_value.reg))
+    {
+      return false;
+    }
+    program_.code_[jump_to_end].a = uint16_t(program_.code_.size());
+    return true;
+  }
+
+  bool newRegister(uint16_t& reg)
+  {
+    if(registers_count_ >= ScriptBytecode::MAX_REGISTERS)
+    {
+      return false;
+    }
+    reg = registers_count_++;
+    return true;
+  }
+
+  bool emit(OpCode op, uint16_t dst = 0, uint16_t a = 0, uint16_t b = 0)
+  {
+    if(program_.code_.size() >= std::numeric_limits<uint16_t>::max())
+    {
+      return false;
+    }
+    program_.code_.push_back({ op, dst, a, b });
+    return true;
+  }
+
+  uint16_t addConstant(double value)
+  {
+    program_.constants_.push_back(value);
+    return uint16_t(program_.constants_.size() - 1);
+  }
+};
+
+std::unique_ptr<ScriptBytecode>
+ScriptBytecode::compile(const std::shared_ptr<ExprBase>& expr, const EnumsTable* enums)
+{
+  auto program = std::make_unique<ScriptBytecode>();
+  program->enums_ = enums;
+  BytecodeCompiler compiler(*program, enums);
+
+  const ExprBase* value_expr = expr.get();
+  if(auto assignment = std::dynamic_pointer_cast<ExprAssignment>(expr))
+  {
+    if(!dynamic_cast<const ExprName*>(assignment->lhs.get()))
+    {
+      return nullptr;
+    }
+    program->assignment_ = assignment;
+    program->assignment_slot_ = compiler.addVariable(assignment->lhsName());
+    value_expr = assignment->rhs.get();
+  }
+  // A literal or a variable alone would return its own type, not double.
+  // Nothing to gain, compiling them anyway.
+  BytecodeCompiler::Operand result;
+  if(!ProducesDouble(value_expr) || !compiler.compile(value_expr, result) ||
+     !compiler.toRegister(result))
+  {
+    return nullptr;
+  }
+  program->result_register_ = result.reg;
+  return program;
+}
+
+bool ScriptBytecode::bind(const Environment& env, Bindings& bindings) const
+{
+  if(!env.vars)
+  {
+    return false;
+  }
+  // read the version first: a change happening during the lookup
+  // will be detected by the next execution.
+  const uint64_t version = Blackboard::structureVersion();
+  if(bindings.blackboard != env.vars.get() || bindings.structure_version != version ||
+     bindings.entries.size() != names_.size())
+  {
+    bindings.entries.resize(names_.size());
+    for(size_t i = 0; i < names_.size(); i++)
+    {
+      bindings.entries[i] = env.vars->getEntry(names_[i]);
+    }
+    bindings.blackboard = env.vars.get();
+    bindings.structure_version = version;
+  }
+  return true;
+}
+
+bool ScriptBytecode::execute(Environment& env, Any& result, Bindings* bindings) const
+{
+  // the enums were replaced by constants, using a different table
+  if(enums_ && env.enums.get() != enums_)
+  {
+    return false;
+  }
+  // not linked: the variables must be searched by name, because they could be enums
+  if(!enums_ && env.enums && !env.enums->empty())
+  {
+    bindings = nullptr;
+  }
+  if(bindings && !bind(env, *bindings))
+  {
+    return false;
+  }
+
+  double reg[MAX_REGISTERS];
+  const Instruction* code = code_.data();
+  const size_t code_size = code_.size();
+
+  for(size_t pc = 0; pc < code_size; pc++)
+  {
+    const Instruction& inst = code[pc];
+    double& dst = reg[inst.dst];
+    switch(inst.op)
+    {
+      case OpCode::LOAD_CONST:
+        dst = constants_[inst.a];
+        break;
+
+      case OpCode::LOAD_VAR: {
+        std::shared_ptr<Blackboard::Entry> looked_up;
+        const Blackboard::Entry* entry = nullptr;
+        if(bindings)
+        {
+          entry = bindings->entries[inst.a].get();
+        }
+        else
+        {
+          const std::string& name = names_[inst.a];
+          // same order used by ExprName: enums first
+          if(!enums_ && env.enums && env.enums->count(name) != 0)
+          {
+            dst = double(env.enums->at(name));
+            break;
+          }
+          looked_up = env.vars->getEntry(name);
+          entry = looked_up.get();
+        }
+        if(!entry)
+        {
+          return false;
+        }
+        std::unique_lock lk(entry->entry_mutex);
+        if(!entry->value.tryCastNumber(dst))
+        {
+          return false;
+        }
+      }
+      break;
+
+      case OpCode::MOVE:
+        dst = reg[inst.a];
+        break;
+
+      case OpCode::JUMP:
+        pc = size_t(inst.a) - 1;
+        break;
+      case OpCode::JUMP_IF_FALSE:
+        if(reg[inst.a] == 0.0)
+        {
+          pc = size_t(inst.b) - 1;
+        }
+        break;
+
+      default:
+        if(!ApplyOperator(inst.op, reg[inst.a], reg[inst.b], dst))
+        {
+          return false;
+        }
+        break;
+    }
+  }
+
+  if(assignment_)
+  {
+    std::shared_ptr<Blackboard::Entry> entry;
+    if(bindings)
+    {
+      entry = bindings->entries[assignment_slot_];
+    }
+    if(!entry)
+    {
+      entry = assignment_->getOrCreateEntry(env);
+    }
+    result = assignment_->assign(env, *entry, Any(reg[result_register_]));
+  }
+  else
+  {
+    result = Any(reg[result_register_]);
+  }
+  return true;
+}
+
+}  // namespace BT::Ast
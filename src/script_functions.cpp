@@ -0,0 +1,498 @@
+#include "behaviortree_cpp/scripting/operators.hpp"
+
+#include <mutex>
+#include <variant>
+
+namespace BT::Ast
+{
+
+namespace
+{
+template <typename T>
+struct Span
+{
+  const T* data = nullptr;
+  size_t size = 0;
+};
+
+// an array, or std::monostate if the argument is a number
+using ArrayView = std::variant<std::monostate, Span<double>, Span<float>, Span<int32_t>,
+                               Span<int64_t>>;
+
+//------------------------------------------------------------------------
+// The kernels are written to be vectorized by the compiler: independent
+// accumulators (floating point additions are not associative, therefore
+// the compiler would not reorder a single accumulator) and no branches in
+// the inner loops.
+
+constexpr size_t LANES = 4;
+
+template <typename T>
+double SumKernel(const T* data, size_t size)
+{
+  double acc[LANES] = { 0, 0, 0, 0 };
+  size_t i = 0;
+  for(; i + LANES <= size; i += LANES)
+  {
+    for(size_t k = 0; k < LANES; k++)
+    {
+      acc[k] += static_cast<double>(data[i + k]);
+    }
+  }
+  double total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for(; i < size; i++)
+  {
+    total += static_cast<double>(data[i]);
+  }
+  return total;
+}
+
+template <bool IS_MIN, typename T>
+double MinMaxKernel(const T* data, size_t size)
+{
+  auto Select = [](double a, double b) {
+    if constexpr(IS_MIN)
+    {
+      return b < a ? b : a;
+    }
+    else
+    {
+      return b > a ? b : a;
+    }
+  };
+  double acc[LANES];
+  for(size_t k = 0; k < LANES; k++)
+  {
+    acc[k] = static_cast<double>(data[0]);
+  }
+  size_t i = 0;
+  for(; i + LANES <= size; i += LANES)
+  {
+    for(size_t k = 0; k < LANES; k++)
+    {
+      acc[k] = Select(acc[k], static_cast<double>(data[i + k]));
+    }
+  }
+  double result = Select(Select(acc[0], acc[1]), Select(acc[2], acc[3]));
+  for(; i < size; i++)
+  {
+    result = Select(result, static_cast<double>(data[i]));
+  }
+  return result;
+}
+
+template <typename T, typename U>
+double DotKernel(const T* a, const U* b, size_t size)
+{
+  double acc[LANES] = { 0, 0, 0, 0 };
+  size_t i = 0;
+  for(; i + LANES <= size; i += LANES)
+  {
+    for(size_t k = 0; k < LANES; k++)
+    {
+      acc[k] += static_cast<double>(a[i + k]) * static_cast<double>(b[i + k]);
+    }
+  }
+  double total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for(; i < size; i++)
+  {
+    total += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+  }
+  return total;
+}
+
+// Count the elements that satisfy the predicate. The array is processed in blocks,
+// and the loop stops early as soon as the result of any() / all() is known.
+template <ExprFunction::func_t FUNC, typename T, typename Predicate>
+size_t CountKernel(const T* data, size_t size, Predicate predicate)
+{
+  constexpr size_t BLOCK = 64;
+  size_t count = 0;
+  for(size_t begin = 0; begin < size; begin += BLOCK)
+  {
+    const size_t end = std::min(size, begin + BLOCK);
+    size_t block_count = 0;
+    for(size_t i = begin; i < end; i++)
+    {
+      block_count += predicate(static_cast<double>(data[i])) ? 1 : 0;
+    }
+    count += block_count;
+    if constexpr(FUNC == ExprFunction::any)
+    {
+      if(count > 0)
+      {
+        return count;
+      }
+    }
+    if constexpr(FUNC == ExprFunction::all)
+    {
+      if(block_count != end - begin)
+      {
+        return count;
+      }
+    }
+  }
+  return count;
+}
+
+template <ExprFunction::func_t FUNC, typename T>
+size_t CountIf(const T* data, size_t size, ExprComparison::op_t op, double value)
+{
+  // same semantic of ExprComparison
+  constexpr double EPS = static_cast<double>(std::numeric_limits<float>::epsilon());
+  switch(op)
+  {
+    case ExprComparison::equal:
+      return CountKernel<FUNC>(data, size,
+                               [value](double v) { return std::abs(v - value) <= EPS; });
+    case ExprComparison::not_equal:
+      return CountKernel<FUNC>(data, size,
+                               [value](double v) { return std::abs(v - value) > EPS; });
+    case ExprComparison::less:
+      return CountKernel<FUNC>(data, size, [value](double v) { return !(v >= value); });
+    case ExprComparison::greater:
+      return CountKernel<FUNC>(data, size, [value](double v) { return !(v <= value); });
+    case ExprComparison::less_equal:
+      return CountKernel<FUNC>(data, size, [value](double v) { return !(v > value); });
+    case ExprComparison::greater_equal:
+      return CountKernel<FUNC>(data, size, [value](double v) { return !(v < value); });
+  }
+  return 0;
+}
+
+// "x < v" is the same as "v > x"
+ExprComparison::op_t MirrorComparison(ExprComparison::op_t op)
+{
+  switch(op)
+  {
+    case ExprComparison::less:
+      return ExprComparison::greater;
+    case ExprComparison::greater:
+      return ExprComparison::less;
+    case ExprComparison::less_equal:
+      return ExprComparison::greater_equal;
+    case ExprComparison::greater_equal:
+      return ExprComparison::less_equal;
+    default:
+      return op;
+  }
+}
+
+//------------------------------------------------------------------------
+
+template <typename T>
+bool TryView(Any& value, ArrayView& view)
+{
+  if(auto vect = value.castPtr<std::vector<T>>())
+  {
+    view = Span<T>{ vect->data(), vect->size() };
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Arguments of a function that may be arrays (one or two).
+ * Arrays stored in the blackboard are not copied: their entries are kept
+ * locked until this object is destroyed.
+ */
+class ArrayArguments
+{
+public:
+  ArrayArguments(const char* func_name, Environment& env, const expr_ptr* exprs,
+                 size_t count)
+    : func_name_(func_name)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      auto name = dynamic_cast<const ExprName*>(exprs[i].get());
+      const bool is_enum = name && env.enums && env.enums->count(name->name) != 0;
+      if(name && !is_enum)
+      {
+        entries_[i] = env.vars->getEntry(name->name);
+        if(!entries_[i])
+        {
+          throw RuntimeError(StrCat("Variable not found: ", name->name));
+        }
+      }
+      else
+      {
+        temporaries_[i] = exprs[i]->evaluate(env);
+      }
+    }
+
+    // lock the entries. std::lock prevents deadlocks with other scripts
+    // using the same entries in a different order.
+    if(count == 2 && entries_[0] && entries_[1] && entries_[0] != entries_[1])
+    {
+      locks_[0] = std::unique_lock(entries_[0]->entry_mutex, std::defer_lock);
+      locks_[1] = std::unique_lock(entries_[1]->entry_mutex, std::defer_lock);
+      std::lock(locks_[0], locks_[1]);
+    }
+    else
+    {
+      for(size_t i = 0; i < count; i++)
+      {
+        if(entries_[i] && (i == 0 || entries_[i] != entries_[0]))
+        {
+          locks_[i] = std::unique_lock(entries_[i]->entry_mutex);
+        }
+      }
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+      Any& value = entries_[i] ? entries_[i]->value : temporaries_[i];
+      if(value.empty())
+      {
+        throw RuntimeError(StrCat("The argument of ", func_name_, "() is not initialized"));
+      }
+      if(value.isNumber())
+      {
+        scalars_[i] = value.cast<double>();
+      }
+      else if(!TryView<double>(value, views_[i]) && !TryView<float>(value, views_[i]) &&
+              !TryView<int32_t>(value, views_[i]) && !TryView<int64_t>(value, views_[i]))
+      {
+        if(!value.isString())
+        {
+          throw RuntimeError(StrCat("The argument of ", func_name_,
+                                    "() must be a number or an array, not [",
+                                    BT::demangle(value.type()), "]"));
+        }
+        // arrays written in the XML, i.e. "1;2;3"
+        converted_[i] = convertFromString<std::vector<double>>(value.cast<std::string>());
+        views_[i] = Span<double>{ converted_[i].data(), converted_[i].size() };
+      }
+    }
+  }
+
+  bool isArray(size_t index) const
+  {
+    return !std::holds_alternative<std::monostate>(views_[index]);
+  }
+
+  const ArrayView& array(size_t index) const
+  {
+    if(!isArray(index))
+    {
+      throw RuntimeError(StrCat("The argument of ", func_name_, "() must be an array"));
+    }
+    return views_[index];
+  }
+
+  double scalar(size_t index) const
+  {
+    if(isArray(index))
+    {
+      throw RuntimeError(StrCat("The argument of ", func_name_, "() must be a number"));
+    }
+    return scalars_[index];
+  }
+
+  // number of elements of an array argument
+  size_t size(size_t index) const
+  {
+    return std::visit(
+        [](const auto& span) -> size_t {
+          if constexpr(std::is_same_v<std::decay_t<decltype(span)>, std::monostate>)
+          {
+            return 0;
+          }
+          else
+          {
+            return span.size;
+          }
+        },
+        views_[index]);
+  }
+
+private:
+  const char* func_name_;
+  std::shared_ptr<Blackboard::Entry> entries_[2];
+  std::unique_lock<std::mutex> locks_[2];
+  Any temporaries_[2];
+  std::vector<double> converted_[2];
+  ArrayView views_[2];
+  double scalars_[2] = { 0, 0 };
+};
+
+// Call func(span) with the array
+template <typename Func>
+double VisitArray(const ArrayView& view, Func&& func)
+{
+  return std::visit(
+      [&](const auto& span) -> double {
+        if constexpr(std::is_same_v<std::decay_t<decltype(span)>, std::monostate>)
+        {
+          return 0;
+        }
+        else
+        {
+          return func(span);
+        }
+      },
+      view);
+}
+
+const char* FunctionName(ExprFunction::func_t func)
+{
+  switch(func)
+  {
+    case ExprFunction::min:
+      return "min";
+    case ExprFunction::max:
+      return "max";
+    case ExprFunction::sum:
+      return "sum";
+    case ExprFunction::dot:
+      return "dot";
+    case ExprFunction::any:
+      return "any";
+    case ExprFunction::all:
+      return "all";
+    case ExprFunction::count:
+      return "count";
+  }
+  return "";
+}
+
+}  // namespace
+
+ExprFunction::ExprFunction(const std::string& name, std::vector<expr_ptr> arguments)
+  : args(std::move(arguments))
+{
+  static const std::unordered_map<std::string, func_t> functions = {
+    { "min", min }, { "max", max }, { "sum", sum },     { "dot", dot },
+    { "any", any }, { "all", all }, { "count", count },
+  };
+  auto it = functions.find(name);
+  if(it == functions.end())
+  {
+    throw RuntimeError(StrCat("Unknown function: ", name));
+  }
+  func = it->second;
+
+  size_t min_args = 1;
+  size_t max_args = 1;
+  if(func == min || func == max)
+  {
+    max_args = std::numeric_limits<size_t>::max();
+  }
+  else if(func == dot)
+  {
+    min_args = max_args = 2;
+  }
+  if(args.size() < min_args || args.size() > max_args)
+  {
+    throw RuntimeError(StrCat("Wrong number of arguments in ", name, "()"));
+  }
+  if(func == any || func == all || func == count)
+  {
+    auto comparison = dynamic_cast<const ExprComparison*>(args.front().get());
+    if(!comparison || comparison->ops.size() != 1)
+    {
+      throw RuntimeError(StrCat("The argument of ", name,
+                                "() must be a comparison between an array and a "
+                                "number, for instance: ",
+                                name, "(values > 5)"));
+    }
+  }
+}
+
+Any ExprFunction::evaluate(Environment& env) const
+{
+  const char* name = FunctionName(func);
+  switch(func)
+  {
+    case min:
+    case max: {
+      // min(a, b, c...)
+      if(args.size() > 1)
+      {
+        double result = 0;
+        for(size_t i = 0; i < args.size(); i++)
+        {
+          const double value = ArrayArguments(name, env, &args[i], 1).scalar(0);
+          result = (i == 0 || (func == min ? value < result : value > result)) ? value :
+                                                                                 result;
+        }
+        return Any(result);
+      }
+      ArrayArguments arguments(name, env, args.data(), 1);
+      if(arguments.size(0) == 0)
+      {
+        throw RuntimeError(StrCat(name, "() of an empty array"));
+      }
+      return Any(VisitArray(arguments.array(0), [this](const auto& span) {
+        return func == min ? MinMaxKernel<true>(span.data, span.size) :
+                             MinMaxKernel<false>(span.data, span.size);
+      }));
+    }
+
+    case sum: {
+      ArrayArguments arguments(name, env, args.data(), 1);
+      return Any(VisitArray(arguments.array(0), [](const auto& span) {
+        return SumKernel(span.data, span.size);
+      }));
+    }
+
+    case dot: {
+      ArrayArguments arguments(name, env, args.data(), 2);
+      const auto& a = arguments.array(0);
+      const auto& b = arguments.array(1);
+      if(arguments.size(0) != arguments.size(1))
+      {
+        throw RuntimeError(StrCat("dot() of arrays with different size: ",
+                                  std::to_string(arguments.size(0)), " and ",
+                                  std::to_string(arguments.size(1))));
+      }
+      return Any(VisitArray(a, [&b](const auto& span_a) {
+        return VisitArray(b, [&span_a](const auto& span_b) {
+          return DotKernel(span_a.data, span_b.data, span_a.size);
+        });
+      }));
+    }
+
+    case any:
+    case all:
+    case count: {
+      const auto& comparison = static_cast<const ExprComparison&>(*args.front());
+      ArrayArguments arguments(name, env, comparison.operands.data(), 2);
+      auto op = comparison.ops.front();
+      size_t array_index = 0;
+      if(!arguments.isArray(0))
+      {
+        op = MirrorComparison(op);
+        array_index = 1;
+      }
+      const double value = arguments.scalar(1 - array_index);
+      const size_t size = arguments.size(array_index);
+
+      const double matching =
+          VisitArray(arguments.array(array_index), [&](const auto& span) -> double {
+            if(func == any)
+            {
+              return double(CountIf<any>(span.data, span.size, op, value));
+            }
+            if(func == all)
+            {
+              return double(CountIf<all>(span.data, span.size, op, value));
+            }
+            return double(CountIf<count>(span.data, span.size, op, value));
+          });
+      if(func == any)
+      {
+        return Any(matching > 0 ? 1.0 : 0.0);
+      }
+      if(func == all)
+      {
+        return Any(matching == double(size) ? 1.0 : 0.0);
+      }
+      return Any(matching);
+    }
+  }
+  return {};
+}
+
+}  // namespace BT::Ast
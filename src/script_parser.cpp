@@ -1,57 +1,291 @@
 #include "behaviortree_cpp/scripting/script_parser.hpp"
 #include "behaviortree_cpp/scripting/operators.hpp"
+#include "behaviortree_cpp/scripting/script_bytecode.hpp"
 
 #include <lexy/action/parse.hpp>
 #include <lexy/action/validate.hpp>
 #include <lexy_ext/report_error.hpp>
 #include <lexy/input/string_input.hpp>
 
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <string_view>
+
 namespace BT
 {
 
 using ErrorReport = lexy_ext::_report_error<char*>;
 
-Expected<ScriptFunction> ParseScript(const std::string& script)
+namespace
+{
+// Result of the parsing, without any state related to the execution.
+// It is immutable, therefore it can be shared by multiple ScriptFunctions.
+struct ParsedStatement
+{
+  Ast::ExprBase::Ptr expr;
+  // compiled without enums: nullptr if this statement can't be compiled at all
+  std::shared_ptr<const Ast::ScriptBytecode> bytecode;
+};
+using ParsedScript = std::vector<ParsedStatement>;
+
+// Identical scripts are very common (the same subtree instantiated many times,
+// the same precondition in many nodes), and parsing is expensive.
+// This cache is shared by all the factories; the key is the script itself.
+// When full, the least recently used script is removed.
+class ScriptCache
+{
+public:
+  std::shared_ptr<const ParsedScript> find(const std::string& script)
+  {
+    std::unique_lock lk(mutex_);
+    auto it = index_.find(script);
+    if(it == index_.end())
+    {
+      return nullptr;
+    }
+    scripts_.splice(scripts_.begin(), scripts_, it->second);
+    return it->second->second;
+  }
+
+  void insert(const std::string& script, std::shared_ptr<const ParsedScript> parsed)
+  {
+    std::unique_lock lk(mutex_);
+    // another thread may have parsed the same script in the meantime
+    if(index_.count(script) != 0)
+    {
+      return;
+    }
+    scripts_.emplace_front(script, std::move(parsed));
+    index_.insert({ scripts_.front().first, scripts_.begin() });
+    // keep the memory bounded, even if scripts are generated at run-time
+    if(scripts_.size() > MAX_SIZE)
+    {
+      index_.erase(scripts_.back().first);
+      scripts_.pop_back();
+    }
+  }
+
+  size_t size() const
+  {
+    std::unique_lock lk(mutex_);
+    return scripts_.size();
+  }
+
+  void clear()
+  {
+    std::unique_lock lk(mutex_);
+    index_.clear();
+    scripts_.clear();
+  }
+
+  static ScriptCache& get()
+  {
+    static ScriptCache cache;
+    return cache;
+  }
+
+private:
+  static constexpr size_t MAX_SIZE = 4096;
+  using Entry = std::pair<std::string, std::shared_ptr<const ParsedScript>>;
+
+  mutable std::mutex mutex_;
+  // most recently used first
+  std::list<Entry> scripts_;
+  // the keys point to the strings stored in scripts_
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+};
+
+Expected<std::shared_ptr<const ParsedScript>> ParseStatements(const std::string& script)
 {
   char error_msgs_buffer[2048];
 
-  auto input = lexy::string_input<lexy::utf8_encoding>(script);
-  auto result =
-      lexy::parse<BT::Grammar::stmt>(input, ErrorReport().to(error_msgs_buffer));
-  if(result.has_value() && result.error_count() == 0)
+  // the AST may throw while parsing, for instance if a function doesn't exist
+  try
   {
-    try
+    auto input = lexy::string_input<lexy::utf8_encoding>(script);
+    auto result =
+        lexy::parse<BT::Grammar::stmt>(input, ErrorReport().to(error_msgs_buffer));
+    if(!result.has_value() || result.error_count() != 0)
+    {
+      return nonstd::make_unexpected(error_msgs_buffer);
+    }
+    std::vector<BT::Ast::ExprBase::Ptr> exprs = LEXY_MOV(result).value();
+    if(exprs.empty())
+    {
+      return nonstd::make_unexpected("Empty Script");
+    }
+    auto parsed = std::make_shared<ParsedScript>();
+    parsed->reserve(exprs.size());
+    for(auto& expr : exprs)
+    {
+      parsed->push_back({ expr, Ast::ScriptBytecode::compile(expr) });
+    }
+    return std::shared_ptr<const ParsedScript>(std::move(parsed));
+  }
+  catch(std::runtime_error& err)
+  {
+    return nonstd::make_unexpected(err.what());
+  }
+  catch(RuntimeError& err)
+  {
+    return nonstd::make_unexpected(err.what());
+  }
+}
+Expected<std::shared_ptr<const ParsedScript>>
+FindOrParseStatements(const std::string& script)
+{
+  auto& cache = ScriptCache::get();
+  if(auto parsed = cache.find(script))
+  {
+    return parsed;
+  }
+  auto result = ParseStatements(script);
+  if(result)
+  {
+    cache.insert(script, result.value());
+  }
+  return result;
+}
+
+// Add to "names" the variables read by the expression.
+// Return false if the expression contains an assignment.
+bool CollectVariables(const Ast::ExprBase* expr, std::vector<std::string>& names)
+{
+  using namespace Ast;
+  if(auto name = dynamic_cast<const ExprName*>(expr))
+  {
+    if(std::find(names.begin(), names.end(), name->name) == names.end())
     {
-      std::vector<BT::Ast::ExprBase::Ptr> exprs = LEXY_MOV(result).value();
-      if(exprs.empty())
+      names.push_back(name->name);
+    }
+    return true;
+  }
+  if(dynamic_cast<const ExprAssignment*>(expr))
+  {
+    return false;
+  }
+  if(auto unary = dynamic_cast<const ExprUnaryArithmetic*>(expr))
+  {
+    return CollectVariables(unary->rhs.get(), names);
+  }
+  if(auto binary = dynamic_cast<const ExprBinaryArithmetic*>(expr))
+  {
+    return CollectVariables(binary->lhs.get(), names) &&
+           CollectVariables(binary->rhs.get(), names);
+  }
+  if(auto if_expr = dynamic_cast<const ExprIf*>(expr))
+  {
+    return CollectVariables(if_expr->condition.get(), names) &&
+           CollectVariables(if_expr->then.get(), names) &&
+           CollectVariables(if_expr->else_.get(), names);
+  }
+  const std::vector<expr_ptr>* operands = nullptr;
+  if(auto comparison = dynamic_cast<const ExprComparison*>(expr))
+  {
+    operands = &comparison->operands;
+  }
+  else if(auto function = dynamic_cast<const ExprFunction*>(expr))
+  {
+    operands = &function->args;
+  }
+  if(operands)
+  {
+    for(const auto& operand : *operands)
+    {
+      if(!CollectVariables(operand.get(), names))
       {
-        return nonstd::make_unexpected("Empty Script");
+        return false;
       }
+    }
+  }
+  // literals
+  return true;
+}
+}  // namespace
+
+Expected<ScriptFunction> ParseScript(const std::string& script)
+{
+  auto result = FindOrParseStatements(script);
+  if(!result)
+  {
+    return nonstd::make_unexpected(result.error());
+  }
+  auto parsed = result.value();
 
-      return [exprs, script](Ast::Environment& env) -> Any {
-        try
+  // Statements are executed as bytecode, when possible.
+  // The AST is used when the bytecode gives up, or it wasn't compiled.
+  // The bytecode is linked to the table of enums of the environment and
+  // to its blackboard entries at the first execution (see ScriptFunction).
+  struct Statement
+  {
+    std::shared_ptr<const Ast::ScriptBytecode> linked;
+    // keep it alive, because the linked bytecode refers to it
+    EnumsTablePtr linked_enums;
+    Ast::ScriptBytecode::Bindings bindings;
+  };
+  std::vector<Statement> statements(parsed->size());
+
+  return [parsed = std::move(parsed), statements = std::move(statements),
+          script](Ast::Environment& env) mutable -> Any {
+    try
+    {
+      Any result;
+      for(size_t i = 0; i < statements.size(); i++)
+      {
+        const auto& source = (*parsed)[i];
+        auto& statement = statements[i];
+        if(source.bytecode && (!statement.linked || statement.linked_enums != env.enums))
         {
-          for(auto i = 0u; i < exprs.size() - 1; ++i)
+          statement.linked_enums = env.enums;
+          statement.linked = Ast::ScriptBytecode::compile(source.expr, env.enums.get());
+          if(!statement.linked)
           {
-            exprs[i]->evaluate(env);
+            statement.linked = source.bytecode;
           }
-          return exprs.back()->evaluate(env);
         }
-        catch(RuntimeError& err)
+        if(!statement.linked ||
+           !statement.linked->execute(env, result, &statement.bindings))
         {
-          throw RuntimeError(StrCat("Error in script [", script, "]\n", err.what()));
+          result = source.expr->evaluate(env);
         }
-      };
+      }
+      return result;
     }
-    catch(std::runtime_error& err)
+    catch(RuntimeError& err)
     {
-      return nonstd::make_unexpected(err.what());
+      throw RuntimeError(StrCat("Error in script [", script, "]\n", err.what()));
     }
+  };
+}
+
+Expected<std::vector<std::string>> ScriptDependencies(const std::string& script)
+{
+  auto parsed = FindOrParseStatements(script);
+  if(!parsed)
+  {
+    return nonstd::make_unexpected(parsed.error());
   }
-  else
+  std::vector<std::string> names;
+  for(const auto& statement : *parsed.value())
   {
-    return nonstd::make_unexpected(error_msgs_buffer);
+    if(!CollectVariables(statement.expr.get(), names))
+    {
+      return nonstd::make_unexpected(
+          StrCat("The script [", script, "] modifies the blackboard"));
+    }
   }
+  return names;
+}
+
+size_t ScriptCacheSize()
+{
+  return ScriptCache::get().size();
+}
+
+void ClearScriptCache()
+{
+  ScriptCache::get().clear();
 }
 
 BT::Expected<Any> ParseScriptAndExecute(Ast::Environment& env, const std::string& script)
@@ -71,27 +305,31 @@ Result ValidateScript(const std::string& script)
 {
   char error_msgs_buffer[2048];
 
-  auto input = lexy::string_input<lexy::utf8_encoding>(script);
-  auto result =
-      lexy::parse<BT::Grammar::stmt>(input, ErrorReport().to(error_msgs_buffer));
-  if(result.has_value() && result.error_count() == 0)
+  try
   {
-    try
+    auto input = lexy::string_input<lexy::utf8_encoding>(script);
+    auto result =
+        lexy::parse<BT::Grammar::stmt>(input, ErrorReport().to(error_msgs_buffer));
+    if(!result.has_value() || result.error_count() != 0)
     {
-      std::vector<BT::Ast::ExprBase::Ptr> exprs = LEXY_MOV(result).value();
-      if(exprs.empty())
-      {
-        return nonstd::make_unexpected("Empty Script");
-      }
-      // valid script
-      return {};
+      return nonstd::make_unexpected(error_msgs_buffer);
     }
-    catch(std::runtime_error& err)
+    std::vector<BT::Ast::ExprBase::Ptr> exprs = LEXY_MOV(result).value();
+    if(exprs.empty())
     {
-      return nonstd::make_unexpected(err.what());
+      return nonstd::make_unexpected("Empty Script");
     }
+    // valid script
+    return {};
+  }
+  catch(std::runtime_error& err)
+  {
+    return nonstd::make_unexpected(err.what());
+  }
+  catch(RuntimeError& err)
+  {
+    return nonstd::make_unexpected(err.what());
   }
-  return nonstd::make_unexpected(error_msgs_buffer);
 }
 
 }  // namespace BT
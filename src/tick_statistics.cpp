@@ -0,0 +1,72 @@
+#include "behaviortree_cpp/utils/tick_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace BT
+{
+
+TickStatistics::TickStatistics(size_t window) : window_(std::max<size_t>(window, 1))
+{}
+
+void TickStatistics::reset()
+{
+  *this = TickStatistics(window_);
+}
+
+void TickStatistics::addTick(Duration duration, bool overrun)
+{
+  if(durations_.size() < window_)
+  {
+    durations_.push_back(duration);
+  }
+  else
+  {
+    durations_[next_] = duration;
+  }
+  next_ = (next_ + 1) % window_;
+
+  tick_count_++;
+  overrun_count_ += overrun ? 1 : 0;
+  max_duration_ = std::max(max_duration_, duration);
+}
+
+void TickStatistics::addJitter(Duration jitter)
+{
+  jitter = (jitter.count() < 0) ? -jitter : jitter;
+  jitter_count_++;
+  jitter_sum_ += jitter;
+  max_jitter_ = std::max(max_jitter_, jitter);
+}
+
+void TickStatistics::addMissedDeadlines(uint64_t count)
+{
+  missed_deadlines_ += count;
+}
+
+TickStatistics::Duration TickStatistics::meanJitter() const
+{
+  if(jitter_count_ == 0)
+  {
+    return Duration(0);
+  }
+  return jitter_sum_ / jitter_count_;
+}
+
+TickStatistics::Duration TickStatistics::durationPercentile(double percentile) const
+{
+  if(durations_.empty())
+  {
+    return Duration(0);
+  }
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  const auto rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(durations_.size())));
+  const size_t index = (rank == 0) ? 0 : rank - 1;
+
+  auto sorted = durations_;
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  return sorted[index];
+}
+
+}  // namespace BT
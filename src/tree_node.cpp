@@ -12,12 +12,28 @@
 */
 
 #include "behaviortree_cpp/tree_node.h"
+#include "behaviortree_cpp/control_node.h"
+#include "behaviortree_cpp/decorator_node.h"
 #include <cstring>
 #include <array>
+#include <atomic>
 
 namespace BT
 {
 
+namespace
+{
+// The transitions from and to IDLE happen in the thread that ticks the tree
+// (ThreadedAction changes its status in another thread, but only from RUNNING
+// to SUCCESS or FAILURE), therefore a read-modify-write is not needed; the
+// word is atomic only to let ControlNode read it from any thread.
+void setActiveBit(std::atomic<uint64_t>& word, uint64_t mask, bool active)
+{
+  const uint64_t value = word.load(std::memory_order_relaxed);
+  word.store(active ? (value | mask) : (value & ~mask), std::memory_order_relaxed);
+}
+}  // namespace
+
 struct TreeNode::PImpl
 {
   PImpl(std::string name, NodeConfig config)
@@ -43,11 +59,99 @@ struct TreeNode::PImpl
   TickMonitorCallback tick_monitor_callback;
 
   std::mutex callback_injection_mutex;
+  // true if any of the callbacks above was ever set; otherwise,
+  // executeTick() doesn't need to lock callback_injection_mutex.
+  std::atomic_bool has_callbacks = false;
 
   std::shared_ptr<WakeUpSignal> wake_up;
 
+  // CONTROL or DECORATOR if the node is a ControlNode or a DecoratorNode,
+  // set by their constructors. Used by children().
+  NodeType children_tag = NodeType::UNDEFINED;
+
+  // the result of tick() reused while the entries don't change, see setMemoizedKeys()
+  struct Memo
+  {
+    std::vector<std::string> keys;
+    // resolved again when Blackboard::structureVersion() changes
+    std::vector<std::shared_ptr<Blackboard::Entry>> entries;
+    uint64_t structure_version = 0;
+    bool resolved = false;
+    std::vector<uint64_t> sequence_ids;
+    // IDLE if there is no valid result
+    NodeStatus status = NodeStatus::IDLE;
+  };
+  std::unique_ptr<Memo> memo;
+
+  // see waitsForEvents()
+  bool waits_for_events = false;
+
+  // see setTickPeriod()
+  struct Period
+  {
+    std::chrono::microseconds period;
+    std::chrono::steady_clock::time_point next_tick;
+    // IDLE if the node must be ticked, regardless of next_tick
+    NodeStatus status = NodeStatus::IDLE;
+  };
+  std::unique_ptr<Period> period;
+
+  // the deadline is used by Tree to decide when the tree must be ticked again
+  void reportDeadline()
+  {
+    if(wake_up && period->next_tick < wake_up->next_deadline)
+    {
+      wake_up->next_deadline = period->next_tick;
+    }
+  }
+
+  // see ControlNode::active_children_
+  std::shared_ptr<std::atomic<uint64_t>> active_word;
+  uint64_t active_mask = 0;
+
   std::array<ScriptFunction, size_t(PreCond::COUNT_)> pre_parsed;
   std::array<ScriptFunction, size_t(PostCond::COUNT_)> post_parsed;
+
+  // Bit N is set if pre_parsed[N] is defined, bit (PRE_COUNT + N) if
+  // post_parsed[N] is. The scripts can be modified by the factory or a derived
+  // class through preConditionsScripts() and postConditionsScripts(),
+  // therefore the mask is updated lazily.
+  static constexpr size_t PRE_COUNT = size_t(PreCond::COUNT_);
+  static constexpr uint8_t PRE_CONDITIONS_MASK = (1 << PRE_COUNT) - 1;
+  uint8_t conditions_mask = 0;
+  bool conditions_mask_dirty = true;
+
+  void updateConditionsMask()
+  {
+    conditions_mask = 0;
+    for(size_t i = 0; i < pre_parsed.size(); i++)
+    {
+      conditions_mask |= pre_parsed[i] ? uint8_t(1 << i) : 0;
+    }
+    for(size_t i = 0; i < post_parsed.size(); i++)
+    {
+      conditions_mask |= post_parsed[i] ? uint8_t(1 << (PRE_COUNT + i)) : 0;
+    }
+    conditions_mask_dirty = false;
+  }
+
+  bool hasPostCondition(PostCond cond) const
+  {
+    return (conditions_mask & (1 << (PRE_COUNT + size_t(cond)))) != 0;
+  }
+
+  // Environment of the pre and post conditions, built once.
+  Ast::Environment script_env;
+
+  Ast::Environment& scriptEnvironment()
+  {
+    // comparing the pointers doesn't touch their reference counters
+    if(script_env.vars != config.blackboard || script_env.enums != config.enums)
+    {
+      script_env = { config.blackboard, config.enums };
+    }
+    return script_env;
+  }
 };
 
 TreeNode::TreeNode(std::string name, NodeConfig config)
@@ -68,12 +172,130 @@ TreeNode& TreeNode::operator=(TreeNode&& other) noexcept
 TreeNode::~TreeNode()
 {}
 
+void TreeNode::setChildrenType(NodeType type)
+{
+  _p->children_tag = type;
+}
+
+void TreeNode::setActiveFlag(std::shared_ptr<std::atomic<uint64_t>> word,
+                             uint64_t mask)
+{
+  std::unique_lock<std::mutex> lock(_p->state_mutex);
+  _p->active_word = std::move(word);
+  _p->active_mask = mask;
+  if(_p->status != NodeStatus::IDLE)
+  {
+    setActiveBit(*_p->active_word, mask, true);
+  }
+}
+
+void TreeNode::setMemoizedKeys(std::vector<std::string> keys)
+{
+  _p->memo = std::make_unique<PImpl::Memo>();
+  _p->memo->sequence_ids.resize(keys.size(), 0);
+  _p->memo->keys = std::move(keys);
+}
+
+void TreeNode::setTickPeriod(std::chrono::microseconds period)
+{
+  _p->period = std::make_unique<PImpl::Period>();
+  _p->period->period = period;
+}
+
+NodeStatus TreeNode::tickMemoized()
+{
+  auto& memo = *_p->memo;
+  bool changed = (memo.status == NodeStatus::IDLE);
+
+  const uint64_t structure_version = Blackboard::structureVersion();
+  if(!memo.resolved || memo.structure_version != structure_version)
+  {
+    // an entry may have been created or removed
+    memo.entries.assign(memo.keys.size(), nullptr);
+    for(size_t i = 0; i < memo.keys.size() && _p->config.blackboard; i++)
+    {
+      memo.entries[i] = _p->config.blackboard->getEntry(memo.keys[i]);
+    }
+    memo.structure_version = structure_version;
+    memo.resolved = true;
+    changed = true;
+  }
+  for(size_t i = 0; i < memo.entries.size(); i++)
+  {
+    uint64_t sequence_id = 0;
+    if(const auto& entry = memo.entries[i])
+    {
+      std::scoped_lock lock(entry->entry_mutex);
+      sequence_id = entry->sequence_id;
+    }
+    changed |= (sequence_id != memo.sequence_ids[i]);
+    memo.sequence_ids[i] = sequence_id;
+  }
+  if(!changed)
+  {
+    return memo.status;
+  }
+  memo.status = NodeStatus::IDLE;
+  const NodeStatus status = tick();
+  if(isStatusCompleted(status))
+  {
+    memo.status = status;
+  }
+  return status;
+}
+
+TreeNode::Children TreeNode::children() const
+{
+  switch(_p->children_tag)
+  {
+    case NodeType::CONTROL: {
+      const auto& nodes = static_cast<const ControlNode*>(this)->children_nodes_;
+      return { nodes.data(), nodes.size() };
+    }
+    case NodeType::DECORATOR: {
+      const auto& child = static_cast<const DecoratorNode*>(this)->child_node_;
+      return { &child, child ? 1u : 0u };
+    }
+    default:
+      return {};
+  }
+}
+
 NodeStatus TreeNode::executeTick()
 {
+  if(_p->period)
+  {
+    auto& period = *_p->period;
+    const auto now = std::chrono::steady_clock::now();
+    if(period.status != NodeStatus::IDLE && now < period.next_tick)
+    {
+      // between two periods: the subtree is not traversed at all
+      _p->reportDeadline();
+      if(period.status == NodeStatus::RUNNING && _p->wake_up)
+      {
+        _p->wake_up->running_count++;
+      }
+      // the status changes only when the node is ticked: a completed status
+      // reset by the parent stays IDLE, like a skipped node
+      if(period.status == NodeStatus::RUNNING && status() != NodeStatus::RUNNING)
+      {
+        setStatus(period.status);
+      }
+      return period.status;
+    }
+    // fixed rate, unless a period was missed
+    const bool late = period.status == NodeStatus::IDLE ||
+                      now >= period.next_tick + period.period;
+    period.next_tick = late ? now + period.period : period.next_tick + period.period;
+  }
+
   auto new_status = _p->status;
+  // to know if any child returned RUNNING, see Tree::tickOnceIfNeeded()
+  const uint64_t running_count = _p->wake_up ? _p->wake_up->running_count : 0;
   PreTickCallback pre_tick;
   PostTickCallback post_tick;
   TickMonitorCallback monitor_tick;
+  if(_p->has_callbacks)
   {
     std::scoped_lock lk(_p->callback_injection_mutex);
     pre_tick = _p->pre_tick_callback;
@@ -81,13 +303,24 @@ NodeStatus TreeNode::executeTick()
     monitor_tick = _p->tick_monitor_callback;
   }
 
+  if(_p->conditions_mask_dirty)
+  {
+    _p->updateConditionsMask();
+  }
+
   // a pre-condition may return the new status.
   // In this case it override the actual tick()
-  if(auto precond = checkPreConditions())
+  bool precondition_applied = false;
+  if((_p->conditions_mask & PImpl::PRE_CONDITIONS_MASK) != 0)
   {
-    new_status = precond.value();
+    if(auto precond = checkPreConditions())
+    {
+      new_status = precond.value();
+      precondition_applied = true;
+    }
   }
-  else
+
+  if(!precondition_applied)
   {
     // injected pre-callback
     bool substituted = false;
@@ -118,12 +351,13 @@ NodeStatus TreeNode::executeTick()
         }
       });
 
-      new_status = tick();
+      new_status = _p->memo ? tickMemoized() : tick();
     }
   }
 
   // injected post callback
-  if(isStatusCompleted(new_status))
+  if(isStatusCompleted(new_status) &&
+     (_p->conditions_mask & ~PImpl::PRE_CONDITIONS_MASK) != 0)
   {
     checkPostConditions(new_status);
   }
@@ -137,6 +371,26 @@ NodeStatus TreeNode::executeTick()
     }
   }
 
+  if(_p->period)
+  {
+    _p->period->status =
+        (new_status == NodeStatus::SKIPPED) ? NodeStatus::IDLE : new_status;
+    _p->reportDeadline();
+  }
+
+  if(new_status == NodeStatus::RUNNING && _p->wake_up)
+  {
+    // a node RUNNING because a child is RUNNING leaves the decision to the child
+    if(_p->wake_up->running_count != running_count)
+    {
+      _p->wake_up->running_count++;
+    }
+    else
+    {
+      notifyRunning();
+    }
+  }
+
   // preserve the IDLE state if skipped, but communicate SKIPPED to parent
   if(new_status != NodeStatus::SKIPPED)
   {
@@ -149,11 +403,16 @@ void TreeNode::haltNode()
 {
   halt();
 
+  // a halted subtree must start again, but a completed status is still valid
+  if(_p->period && _p->period->status == NodeStatus::RUNNING)
+  {
+    _p->period->status = NodeStatus::IDLE;
+  }
+
   const auto& parse_executor = _p->post_parsed[size_t(PostCond::ON_HALTED)];
   if(parse_executor)
   {
-    Ast::Environment env = { config().blackboard, config().enums };
-    parse_executor(env);
+    parse_executor(_p->scriptEnvironment());
   }
 }
 
@@ -171,6 +430,10 @@ void TreeNode::setStatus(NodeStatus new_status)
     std::unique_lock<std::mutex> UniqueLock(_p->state_mutex);
     prev_status = _p->status;
     _p->status = new_status;
+    if(prev_status == NodeStatus::IDLE && _p->active_word)
+    {
+      setActiveBit(*_p->active_word, _p->active_mask, true);
+    }
   }
   if(prev_status != new_status)
   {
@@ -182,26 +445,29 @@ void TreeNode::setStatus(NodeStatus new_status)
 
 TreeNode::PreScripts& TreeNode::preConditionsScripts()
 {
+  // the caller may modify them
+  _p->conditions_mask_dirty = true;
   return _p->pre_parsed;
 }
 
 TreeNode::PostScripts& TreeNode::postConditionsScripts()
 {
+  _p->conditions_mask_dirty = true;
   return _p->post_parsed;
 }
 
 Expected<NodeStatus> TreeNode::checkPreConditions()
 {
-  Ast::Environment env = { config().blackboard, config().enums };
+  Ast::Environment& env = _p->scriptEnvironment();
 
   // check the pre-conditions
   for(size_t index = 0; index < size_t(PreCond::COUNT_); index++)
   {
-    const auto& parse_executor = _p->pre_parsed[index];
-    if(!parse_executor)
+    if((_p->conditions_mask & (1 << index)) == 0)
     {
       continue;
     }
+    const auto& parse_executor = _p->pre_parsed[index];
 
     const PreCond preID = PreCond(index);
 
@@ -246,11 +512,9 @@ Expected<NodeStatus> TreeNode::checkPreConditions()
 void TreeNode::checkPostConditions(NodeStatus status)
 {
   auto ExecuteScript = [this](const PostCond& cond) {
-    const auto& parse_executor = _p->post_parsed[size_t(cond)];
-    if(parse_executor)
+    if(_p->hasPostCondition(cond))
     {
-      Ast::Environment env = { config().blackboard, config().enums };
-      parse_executor(env);
+      _p->post_parsed[size_t(cond)](_p->scriptEnvironment());
     }
   };
 
@@ -272,6 +536,10 @@ void TreeNode::resetStatus()
     std::unique_lock<std::mutex> lock(_p->state_mutex);
     prev_status = _p->status;
     _p->status = NodeStatus::IDLE;
+    if(prev_status != NodeStatus::IDLE && _p->active_word)
+    {
+      setActiveBit(*_p->active_word, _p->active_mask, false);
+    }
   }
 
   if(prev_status != NodeStatus::IDLE)
@@ -319,18 +587,21 @@ void TreeNode::setPreTickFunction(PreTickCallback callback)
 {
   std::unique_lock lk(_p->callback_injection_mutex);
   _p->pre_tick_callback = callback;
+  _p->has_callbacks = true;
 }
 
 void TreeNode::setPostTickFunction(PostTickCallback callback)
 {
   std::unique_lock lk(_p->callback_injection_mutex);
   _p->post_tick_callback = callback;
+  _p->has_callbacks = true;
 }
 
 void TreeNode::setTickMonitorCallback(TickMonitorCallback callback)
 {
   std::unique_lock lk(_p->callback_injection_mutex);
   _p->tick_monitor_callback = callback;
+  _p->has_callbacks = true;
 }
 
 uint16_t TreeNode::UID() const
@@ -372,6 +643,13 @@ StringView TreeNode::getRawPortValue(const std::string& key) const
   return remap_it->second;
 }
 
+bool TreeNode::isStaticInput(const std::string& key) const
+{
+  auto remap_it = _p->config.input_ports.find(key);
+  return remap_it == _p->config.input_ports.end() ||
+         !getRemappedKey(key, remap_it->second);
+}
+
 bool TreeNode::isBlackboardPointer(StringView str, StringView* stripped_pointer)
 {
   if(str.size() < 3)
@@ -431,6 +709,25 @@ void TreeNode::emitWakeUpSignal()
   }
 }
 
+bool TreeNode::waitsForEvents() const
+{
+  return _p->waits_for_events;
+}
+
+void TreeNode::setWaitForEvents(bool enable)
+{
+  _p->waits_for_events = enable;
+}
+
+void TreeNode::notifyRunning()
+{
+  if(_p->wake_up)
+  {
+    _p->wake_up->polling_requested |= !_p->waits_for_events;
+    _p->wake_up->running_count++;
+  }
+}
+
 bool TreeNode::requiresWakeUp() const
 {
   return bool(_p->wake_up);
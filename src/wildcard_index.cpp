@@ -0,0 +1,125 @@
+#include "behaviortree_cpp/utils/wildcard_index.h"
+
+#include <algorithm>
+#include "wildcards/wildcards.hpp"
+
+namespace BT
+{
+namespace
+{
+// the characters that may have a special meaning in WildcardMatch
+constexpr const char* WILDCARD_CHARS = "*?\\[]()|";
+}  // namespace
+
+bool WildcardIndex::isLiteral(const std::string& filter)
+{
+  return filter.find_first_of(WILDCARD_CHARS) == std::string::npos;
+}
+
+size_t WildcardIndex::literalPrefixLength(const std::string& filter)
+{
+  return std::min(filter.find_first_of(WILDCARD_CHARS), filter.size());
+}
+
+size_t WildcardIndex::add(const std::string& filter)
+{
+  if(auto it = exact_.find(filter); it != exact_.end())
+  {
+    return it->second;
+  }
+  const size_t index = filters_.size();
+  filters_.push_back(filter);
+  exact_.insert({ filter, index });
+
+  const bool literal = isLiteral(filter);
+  literal_.push_back(literal);
+  if(literal)
+  {
+    return index;
+  }
+
+  const size_t wildcard_pos = literalPrefixLength(filter);
+  uint32_t node = 0;
+  for(size_t i = 0; i < wildcard_pos; i++)
+  {
+    auto it = trie_[node].children.find(filter[i]);
+    if(it == trie_[node].children.end())
+    {
+      it = trie_[node].children.insert({ filter[i], uint32_t(trie_.size()) }).first;
+      trie_.emplace_back();
+    }
+    node = it->second;
+  }
+  // "prefix*" matches any string that reached this node
+  if(wildcard_pos + 1 == filter.size() && filter.back() == '*')
+  {
+    trie_[node].prefix_filter = std::min(trie_[node].prefix_filter, index);
+  }
+  else
+  {
+    trie_[node].filters.push_back(index);
+  }
+  return index;
+}
+
+void WildcardIndex::reserve(size_t count)
+{
+  filters_.reserve(count);
+  literal_.reserve(count);
+  exact_.reserve(count);
+}
+
+void WildcardIndex::clear()
+{
+  filters_.clear();
+  literal_.clear();
+  exact_.clear();
+  trie_.assign(1, TrieNode());
+}
+
+size_t WildcardIndex::firstMatch(const std::string& str) const
+{
+  size_t best = NONE;
+  if(auto it = exact_.find(str); it != exact_.end() && literal_[it->second])
+  {
+    best = it->second;
+  }
+
+  auto visit = [&](const TrieNode& node) {
+    best = std::min(best, node.prefix_filter);
+    for(size_t index : node.filters)
+    {
+      if(index >= best)
+      {
+        break;
+      }
+      if(wildcards::match(str, filters_[index]))
+      {
+        best = index;
+        break;
+      }
+    }
+  };
+
+  uint32_t node = 0;
+  visit(trie_[node]);
+  for(char c : str)
+  {
+    auto it = trie_[node].children.find(c);
+    if(it == trie_[node].children.end())
+    {
+      break;
+    }
+    node = it->second;
+    visit(trie_[node]);
+  }
+  return best;
+}
+
+size_t WildcardIndex::find(const std::string& str) const
+{
+  auto it = exact_.find(str);
+  return (it != exact_.end()) ? it->second : NONE;
+}
+
+}  // namespace BT
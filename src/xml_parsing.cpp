@@ -10,6 +10,7 @@
 *   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <functional>
@@ -18,6 +19,7 @@
 #include <sstream>
 #include <string>
 #include <typeindex>
+#include <variant>
 #include "behaviortree_cpp/basic_types.h"
 
 #if defined(_MSVC_LANG) && !defined(__clang__)
@@ -88,6 +90,123 @@ struct SubtreeModel
   std::unordered_map<std::string, BT::PortInfo> ports;
 };
 
+// Create the entry of a port in the blackboard or, if it exists already,
+// check that the type is the same
+static void CreatePortEntry(Blackboard& blackboard, const std::string& port_key,
+                            const PortInfo& port_info)
+{
+  if(auto prev_info = blackboard.entryInfo(port_key))
+  {
+    // Check consistency of types.
+    bool const port_type_mismatch =
+        (prev_info->isStronglyTyped() && port_info.isStronglyTyped() &&
+         prev_info->type() != port_info.type());
+
+    // special case related to convertFromString
+    bool const string_input = (prev_info->type() == typeid(std::string));
+
+    if(port_type_mismatch && !string_input)
+    {
+      blackboard.debugMessage();
+
+      throw RuntimeError("The creation of the tree failed because the port [",
+                         port_key, "] was initially created with type [",
+                         demangle(prev_info->type()), "] and, later type [",
+                         demangle(port_info.type()), "] was used somewhere else.");
+    }
+  }
+  else
+  {
+    // not found, insert for the first time.
+    blackboard.createEntry(port_key, port_info);
+  }
+}
+
+// Operations recorded while a tree is instantiated by XMLParser::compileTree,
+// and executed again by TreeTemplate::instantiate.
+struct TreeTemplate::PImpl
+{
+  explicit PImpl(const BehaviorTreeFactory& fact) : factory(&fact)
+  {}
+
+  const BehaviorTreeFactory* factory;
+  std::string tree_ID;
+  size_t nodes_count = 0;
+
+  // blackboard of a SubTree
+  struct CreateBlackboard
+  {
+    struct Port
+    {
+      std::string name;
+      std::string value;
+      // a constant value, otherwise the remapping of the port
+      bool is_constant;
+    };
+    int parent;
+    bool autoremap;
+    std::vector<Port> ports;
+  };
+  // entry that must have the type of a port
+  struct CreateEntry
+  {
+    int blackboard;
+    std::string key;
+    PortInfo info;
+    // the port, in the manifest of the node type
+    std::string node_ID;
+    std::string port_name;
+  };
+  struct CreateSubtree
+  {
+    int blackboard;
+    std::string instance_name;
+    std::string tree_ID;
+  };
+  struct CreateNode
+  {
+    std::string name;
+    std::string ID;
+    // without blackboard
+    NodeConfig config;
+    int blackboard;
+    int parent;
+    int subtree;
+    // only if this is a SubTreeNode
+    std::string subtree_ID;
+  };
+  using Step = std::variant<CreateBlackboard, CreateEntry, CreateSubtree, CreateNode>;
+  std::vector<Step> steps;
+
+  // manifests of the node types used by the tree, taken once from the factory
+  // and copied into each instance
+  std::shared_ptr<const std::unordered_map<std::string, TreeNodeManifest>> manifests;
+
+  // to be called when the steps are complete
+  void snapshotManifests()
+  {
+    auto used = std::make_shared<std::unordered_map<std::string, TreeNodeManifest>>();
+    for(const auto& step : steps)
+    {
+      if(auto create_node = std::get_if<CreateNode>(&step))
+      {
+        if(auto manifest = factory->findManifest(create_node->ID))
+        {
+          used->insert({ create_node->ID, *manifest });
+        }
+      }
+    }
+    manifests = std::move(used);
+  }
+
+  // used only while recording. The root blackboard has index 0
+  std::unordered_map<const Blackboard*, int> blackboard_index;
+  std::unordered_map<const TreeNode*, int> node_index;
+  std::unordered_map<const Tree::Subtree*, int> subtree_index;
+  int blackboards_count = 1;
+  int subtrees_count = 0;
+};
+
 struct XMLParser::PImpl
 {
   TreeNode::Ptr createNodeFromXML(const XMLElement* element,
@@ -105,7 +224,8 @@ struct XMLParser::PImpl
 
   void loadDocImpl(XMLDocument* doc, bool add_includes);
 
-  std::list<std::unique_ptr<XMLDocument> > opened_documents;
+  // shared with the snapshots used by the lazy subtrees
+  std::list<std::shared_ptr<XMLDocument> > opened_documents;
   std::map<std::string, const XMLElement*> tree_roots;
 
   const BehaviorTreeFactory& factory;
@@ -115,12 +235,54 @@ struct XMLParser::PImpl
 
   int suffix_count;
 
+  // not null while compiling a TreeTemplate
+  TreeTemplate::PImpl* recorder = nullptr;
+
+  // copy of this parser, used to create the lazy subtrees later
+  std::shared_ptr<PImpl> lazy_snapshot;
+  // number of nodes of each tree, including its subtrees
+  std::unordered_map<std::string, size_t> nodes_count;
+  // the copy of the factory used by a snapshot
+  std::shared_ptr<const BehaviorTreeFactory> owned_factory;
+
+  // The lazy subtrees are created while the tree is ticked, maybe after the
+  // factory was destroyed: the snapshot uses a copy of the factory.
+  std::shared_ptr<PImpl> lazySnapshot()
+  {
+    if(!lazy_snapshot)
+    {
+      auto factory_copy = owned_factory;
+      if(!factory_copy)
+      {
+        factory_copy = factory.cloneNodeTypes();
+      }
+      lazy_snapshot = std::make_shared<PImpl>(*this, std::move(factory_copy));
+    }
+    return lazy_snapshot;
+  }
+
+  size_t countNodes(const std::string& tree_ID);
+
   explicit PImpl(const BehaviorTreeFactory& fact)
     : factory(fact), current_path(std::filesystem::current_path()), suffix_count(0)
   {}
 
+  // copy of "other" that uses "factory_copy" to create the nodes
+  PImpl(const PImpl& other, std::shared_ptr<const BehaviorTreeFactory> factory_copy)
+    : opened_documents(other.opened_documents)
+    , tree_roots(other.tree_roots)
+    , factory(*factory_copy)
+    , current_path(other.current_path)
+    , subtree_models(other.subtree_models)
+    , suffix_count(other.suffix_count)
+    , nodes_count(other.nodes_count)
+    , owned_factory(std::move(factory_copy))
+  {}
+
   void clear()
   {
+    lazy_snapshot.reset();
+    nodes_count.clear();
     suffix_count = 0;
     current_path = std::filesystem::current_path();
     opened_documents.clear();
@@ -230,6 +392,8 @@ void BT::XMLParser::PImpl::loadSubtreeModel(const XMLElement* xml_root)
 
 void XMLParser::PImpl::loadDocImpl(XMLDocument* doc, bool add_includes)
 {
+  lazy_snapshot.reset();
+  nodes_count.clear();
   if(doc->Error())
   {
     char buffer[512];
@@ -576,52 +740,983 @@ void VerifyXML(const std::string& xml_text,
     {
       recursiveStep(child);
     }
-  };
+  };
+
+  for(auto bt_root = xml_root->FirstChildElement("BehaviorTree"); bt_root != nullptr;
+      bt_root = bt_root->NextSiblingElement("BehaviorTree"))
+  {
+    recursiveStep(bt_root);
+  }
+}
+
+Tree XMLParser::instantiateTree(const Blackboard::Ptr& root_blackboard,
+                                std::string main_tree_ID)
+{
+  Tree output_tree;
+
+  // use the main_tree_to_execute argument if it was provided by the user
+  // or the one in the FIRST document opened
+  if(main_tree_ID.empty())
+  {
+    XMLElement* first_xml_root = _p->opened_documents.front()->RootElement();
+
+    if(auto main_tree_attribute = first_xml_root->Attribute("main_tree_to_execute"))
+    {
+      main_tree_ID = main_tree_attribute;
+    }
+    else if(_p->tree_roots.size() == 1)
+    {
+      // special case: there is only one registered BT.
+      main_tree_ID = _p->tree_roots.begin()->first;
+    }
+    else
+    {
+      throw RuntimeError("[main_tree_to_execute] was not specified correctly");
+    }
+  }
+
+  //--------------------------------------
+  if(!root_blackboard)
+  {
+    throw RuntimeError("XMLParser::instantiateTree needs a non-empty "
+                       "root_blackboard");
+  }
+
+  // the factory may have changed since the last tree was created
+  _p->lazy_snapshot.reset();
+  _p->recursivelyCreateSubtree(main_tree_ID, {}, {}, output_tree, root_blackboard,
+                               TreeNode::Ptr());
+  output_tree.initialize();
+  return output_tree;
+}
+
+TreeTemplate::Ptr XMLParser::compileTree(const std::string& tree_name)
+{
+  std::shared_ptr<TreeTemplate> tree_template(new TreeTemplate(_p->factory));
+  auto& recorder = *tree_template->_p;
+
+  // The template records the operations done by a complete instantiation,
+  // that also validates the tree.
+  auto blackboard = Blackboard::create();
+  recorder.blackboard_index[blackboard.get()] = 0;
+  _p->recorder = &recorder;
+  try
+  {
+    auto tree = instantiateTree(blackboard, tree_name);
+    recorder.tree_ID = tree.subtrees.front()->tree_ID;
+  }
+  catch(...)
+  {
+    _p->recorder = nullptr;
+    throw;
+  }
+  _p->recorder = nullptr;
+
+  recorder.blackboard_index.clear();
+  recorder.node_index.clear();
+  recorder.subtree_index.clear();
+  recorder.snapshotManifests();
+  return tree_template;
+}
+
+std::vector<std::string> XMLParser::reloadTree(Tree& tree, const std::string& xml_text)
+{
+  if(tree.subtrees.empty())
+  {
+    throw RuntimeError("XMLParser::reloadTree: the tree is empty");
+  }
+  // the old documents are not released, the old roots remain valid
+  const auto old_roots = _p->tree_roots;
+  loadFromText(xml_text);
+
+  std::unordered_map<std::string, bool> changed_IDs;
+  auto definitionChanged = [&](const std::string& tree_ID) {
+    if(auto it = changed_IDs.find(tree_ID); it != changed_IDs.end())
+    {
+      return it->second;
+    }
+    auto old_it = old_roots.find(tree_ID);
+    auto new_it = _p->tree_roots.find(tree_ID);
+    bool changed = true;
+    if(old_it != old_roots.end() && new_it != _p->tree_roots.end())
+    {
+      XMLPrinter old_printer(nullptr, true);
+      old_it->second->Accept(&old_printer);
+      XMLPrinter new_printer(nullptr, true);
+      new_it->second->Accept(&new_printer);
+      changed = std::strcmp(old_printer.CStr(), new_printer.CStr()) != 0;
+    }
+    changed_IDs[tree_ID] = changed;
+    return changed;
+  };
+
+  auto isDescendant = [](const std::string& path, const std::string& ancestor) {
+    return ancestor.empty() ||
+           (path.size() > ancestor.size() && path[ancestor.size()] == '/' &&
+            path.compare(0, ancestor.size(), ancestor) == 0);
+  };
+
+  // The parents are always before their children in Tree::subtrees
+  std::vector<Tree::Subtree::Ptr> changed_subtrees;
+  for(const auto& subtree : tree.subtrees)
+  {
+    bool rebuilt_ancestor = false;
+    for(const auto& changed : changed_subtrees)
+    {
+      rebuilt_ancestor |= isDescendant(subtree->instance_name, changed->instance_name);
+    }
+    if(!rebuilt_ancestor && definitionChanged(subtree->tree_ID))
+    {
+      changed_subtrees.push_back(subtree);
+    }
+  }
+
+  std::vector<std::string> rebuilt_paths;
+  for(const auto& changed : changed_subtrees)
+  {
+    const bool is_main_tree = (changed == tree.subtrees.front());
+    TreeNode::Ptr parent_node;
+    if(is_main_tree)
+    {
+      tree.haltTree();
+    }
+    else
+    {
+      // find the SubTreeNode, that is not destroyed
+      const TreeNode* old_root = changed->nodes.front().get();
+      for(const auto& subtree : tree.subtrees)
+      {
+        for(const auto& node : subtree->nodes)
+        {
+          auto subtree_node = dynamic_cast<SubTreeNode*>(node.get());
+          if(subtree_node && subtree_node->child() == old_root)
+          {
+            parent_node = node;
+          }
+        }
+      }
+      if(!parent_node)
+      {
+        throw RuntimeError("XMLParser::reloadTree: can't find the parent of [",
+                           changed->instance_name, "]");
+      }
+      if(changed->nodes.front()->status() != NodeStatus::IDLE)
+      {
+        changed->nodes.front()->haltNode();
+      }
+      static_cast<SubTreeNode*>(parent_node.get())->child_node_ = nullptr;
+    }
+
+    // remove the old instance and its descendants. Keep them alive
+    // until the new ones are created
+    std::vector<Tree::Subtree::Ptr> old_subtrees;
+    auto& subtrees = tree.subtrees;
+    auto first_removed =
+        std::stable_partition(subtrees.begin(), subtrees.end(), [&](const auto& subtree) {
+          return subtree != changed &&
+                 !isDescendant(subtree->instance_name, changed->instance_name);
+        });
+    old_subtrees.assign(first_removed, subtrees.end());
+    subtrees.erase(first_removed, subtrees.end());
+
+    const size_t first_new = subtrees.size();
+    const std::string prefix =
+        changed->instance_name.empty() ? std::string() : changed->instance_name + "/";
+    _p->recursivelyCreateSubtree(changed->tree_ID, changed->instance_name, prefix, tree,
+                                 changed->blackboard, parent_node);
+    if(is_main_tree)
+    {
+      // the main tree must be the first one
+      std::rotate(subtrees.begin(), subtrees.begin() + long(first_new), subtrees.end());
+    }
+
+    // copy the content of the blackboards of the nested SubTrees
+    for(const auto& new_subtree : subtrees)
+    {
+      if(new_subtree->blackboard == changed->blackboard ||
+         !isDescendant(new_subtree->instance_name, changed->instance_name))
+      {
+        continue;
+      }
+      for(const auto& old_subtree : old_subtrees)
+      {
+        if(old_subtree->instance_name != new_subtree->instance_name ||
+           old_subtree->tree_ID != new_subtree->tree_ID)
+        {
+          continue;
+        }
+        for(const auto& key : old_subtree->blackboard->getKeys())
+        {
+          auto old_entry = old_subtree->blackboard->getEntry(std::string(key));
+          auto new_entry = new_subtree->blackboard->getEntry(std::string(key));
+          if(!new_entry)
+          {
+            new_subtree->blackboard->createEntry(std::string(key), old_entry->info);
+            new_entry = new_subtree->blackboard->getEntry(std::string(key));
+          }
+          if(new_entry && new_entry != old_entry && new_entry->value.empty())
+          {
+            *new_entry = *old_entry;
+          }
+        }
+      }
+    }
+    rebuilt_paths.push_back(changed->instance_name);
+  }
+
+  if(!changed_subtrees.empty())
+  {
+    tree.initialize();
+  }
+  return rebuilt_paths;
+}
+
+TreeTemplate::TreeTemplate(const BehaviorTreeFactory& factory)
+  : _p(new PImpl(factory))
+{}
+
+TreeTemplate::~TreeTemplate() = default;
+
+const std::string& TreeTemplate::treeID() const
+{
+  return _p->tree_ID;
+}
+
+size_t TreeTemplate::nodesCount() const
+{
+  return _p->nodes_count;
+}
+
+namespace
+{
+// Binary format used by TreeTemplate::serialize(): integers are little-endian,
+// strings and containers are preceded by their size.
+const char TEMPLATE_MAGIC[4] = { 'B', 'T', 'C', 'T' };
+
+enum class StepKind : uint8_t
+{
+  CREATE_BLACKBOARD = 0,
+  CREATE_ENTRY,
+  CREATE_SUBTREE,
+  CREATE_NODE
+};
+
+class BinaryWriter
+{
+public:
+  void write(uint32_t value)
+  {
+    for(int i = 0; i < 4; i++)
+    {
+      buffer.push_back(char((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  void writeInt(int value)
+  {
+    write(static_cast<uint32_t>(value));
+  }
+
+  void write(const std::string& str)
+  {
+    write(static_cast<uint32_t>(str.size()));
+    buffer.append(str);
+  }
+
+  // sorted by key, to write the same buffer every time
+  void write(const std::unordered_map<std::string, std::string>& map)
+  {
+    std::map<std::string, std::string> sorted(map.begin(), map.end());
+    write(static_cast<uint32_t>(sorted.size()));
+    for(const auto& [key, value] : sorted)
+    {
+      write(key);
+      write(value);
+    }
+  }
+
+  template <typename Cond>
+  void write(const std::map<Cond, std::string>& conditions)
+  {
+    write(static_cast<uint32_t>(conditions.size()));
+    for(const auto& [cond, script] : conditions)
+    {
+      write(static_cast<uint32_t>(cond));
+      write(script);
+    }
+  }
+
+  std::string buffer;
+};
+
+class BinaryReader
+{
+public:
+  BinaryReader(const void* data, size_t size)
+    : data_(static_cast<const uint8_t*>(data)), size_(size)
+  {}
+
+  uint32_t readUInt()
+  {
+    check(4);
+    uint32_t value = 0;
+    for(int i = 0; i < 4; i++)
+    {
+      value |= uint32_t(data_[pos_ + i]) << (8 * i);
+    }
+    pos_ += 4;
+    return value;
+  }
+
+  int readInt()
+  {
+    return static_cast<int>(readUInt());
+  }
+
+  uint8_t readByte()
+  {
+    check(1);
+    return data_[pos_++];
+  }
+
+  std::string readString()
+  {
+    const size_t len = readUInt();
+    check(len);
+    std::string str(reinterpret_cast<const char*>(data_ + pos_), len);
+    pos_ += len;
+    return str;
+  }
+
+  std::unordered_map<std::string, std::string> readMap()
+  {
+    std::unordered_map<std::string, std::string> map;
+    const uint32_t count = readUInt();
+    for(uint32_t i = 0; i < count; i++)
+    {
+      auto key = readString();
+      map[key] = readString();
+    }
+    return map;
+  }
+
+  template <typename Cond>
+  std::map<Cond, std::string> readConditions()
+  {
+    std::map<Cond, std::string> conditions;
+    const uint32_t count = readUInt();
+    for(uint32_t i = 0; i < count; i++)
+    {
+      const uint32_t cond = readUInt();
+      if(cond >= uint32_t(Cond::COUNT_))
+      {
+        throw BT::RuntimeError("Invalid compiled tree: wrong condition");
+      }
+      conditions[static_cast<Cond>(cond)] = readString();
+    }
+    return conditions;
+  }
+
+  bool atEnd() const
+  {
+    return pos_ == size_;
+  }
+
+private:
+  void check(size_t bytes) const
+  {
+    if(bytes > size_ - pos_)
+    {
+      throw BT::RuntimeError("Invalid compiled tree: unexpected end of the buffer");
+    }
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+TreeTemplate::Ptr TreeTemplate::rebind(const BehaviorTreeFactory& factory) const
+{
+  std::shared_ptr<TreeTemplate> tree_template(new TreeTemplate(factory));
+  *tree_template->_p = *_p;
+  tree_template->_p->factory = &factory;
+  // the manifests must be the ones of the new factory
+  for(auto& step : tree_template->_p->steps)
+  {
+    if(auto create_node = std::get_if<PImpl::CreateNode>(&step))
+    {
+      if(auto& manifest = create_node->config.manifest)
+      {
+        const auto& ID = manifest->registration_ID;
+        manifest = factory.findManifest(ID);
+        if(!manifest)
+        {
+          throw RuntimeError("TreeTemplate::rebind: the node [", ID,
+                             "] is not registered");
+        }
+      }
+    }
+  }
+  tree_template->_p->snapshotManifests();
+  return tree_template;
+}
+
+std::string TreeTemplate::serialize() const
+{
+  BinaryWriter writer;
+  writer.buffer.append(TEMPLATE_MAGIC, sizeof(TEMPLATE_MAGIC));
+  writer.write(BINARY_FORMAT_VERSION);
+  writer.write(_p->tree_ID);
+  writer.writeInt(_p->blackboards_count);
+  writer.writeInt(_p->subtrees_count);
+  writer.write(static_cast<uint32_t>(_p->nodes_count));
+  writer.write(static_cast<uint32_t>(_p->steps.size()));
+
+  for(const auto& step : _p->steps)
+  {
+    if(auto create_bb = std::get_if<PImpl::CreateBlackboard>(&step))
+    {
+      writer.buffer.push_back(char(StepKind::CREATE_BLACKBOARD));
+      writer.writeInt(create_bb->parent);
+      writer.write(uint32_t(create_bb->autoremap));
+      writer.write(static_cast<uint32_t>(create_bb->ports.size()));
+      for(const auto& port : create_bb->ports)
+      {
+        writer.write(port.name);
+        writer.write(port.value);
+        writer.write(uint32_t(port.is_constant));
+      }
+    }
+    else if(auto create_entry = std::get_if<PImpl::CreateEntry>(&step))
+    {
+      writer.buffer.push_back(char(StepKind::CREATE_ENTRY));
+      writer.writeInt(create_entry->blackboard);
+      writer.write(create_entry->key);
+      writer.write(create_entry->node_ID);
+      writer.write(create_entry->port_name);
+    }
+    else if(auto create_subtree = std::get_if<PImpl::CreateSubtree>(&step))
+    {
+      writer.buffer.push_back(char(StepKind::CREATE_SUBTREE));
+      writer.writeInt(create_subtree->blackboard);
+      writer.write(create_subtree->instance_name);
+      writer.write(create_subtree->tree_ID);
+    }
+    else if(auto create_node = std::get_if<PImpl::CreateNode>(&step))
+    {
+      const auto& config = create_node->config;
+      writer.buffer.push_back(char(StepKind::CREATE_NODE));
+      writer.write(create_node->name);
+      writer.write(create_node->ID);
+      writer.writeInt(create_node->blackboard);
+      writer.writeInt(create_node->parent);
+      writer.writeInt(create_node->subtree);
+      writer.write(create_node->subtree_ID);
+      writer.write(config.manifest ? config.manifest->registration_ID : std::string());
+      writer.write(config.path);
+      writer.write(uint32_t(config.uid));
+      writer.write(config.input_ports);
+      writer.write(config.output_ports);
+      writer.write(config.other_attributes);
+      writer.write(config.pre_conditions);
+      writer.write(config.post_conditions);
+    }
+  }
+  return std::move(writer.buffer);
+}
+
+TreeTemplate::Ptr TreeTemplate::deserialize(const BehaviorTreeFactory& factory,
+                                            const void* data, size_t size)
+{
+  BinaryReader reader(data, size);
+  for(char c : TEMPLATE_MAGIC)
+  {
+    if(reader.readByte() != uint8_t(c))
+    {
+      throw RuntimeError("Invalid compiled tree: wrong file type");
+    }
+  }
+  const uint32_t version = reader.readUInt();
+  if(version != BINARY_FORMAT_VERSION)
+  {
+    throw RuntimeError("The compiled tree uses version ", std::to_string(version),
+                       " of the format, but version ",
+                       std::to_string(BINARY_FORMAT_VERSION), " is expected");
+  }
+
+  std::shared_ptr<TreeTemplate> tree_template(new TreeTemplate(factory));
+  auto& p = *tree_template->_p;
+  p.tree_ID = reader.readString();
+  p.blackboards_count = reader.readInt();
+  p.subtrees_count = reader.readInt();
+  p.nodes_count = reader.readUInt();
+  const uint32_t steps_count = reader.readUInt();
+
+  auto find_manifest = [&](const std::string& ID) -> const TreeNodeManifest& {
+    auto manifest = factory.findManifest(ID);
+    if(!manifest)
+    {
+      throw RuntimeError("The compiled tree uses the node [", ID,
+                         "], that is not registered");
+    }
+    return *manifest;
+  };
+
+  // indexes must refer to objects created by the previous steps
+  int blackboards = 1;
+  int subtrees = 0;
+  size_t nodes = 0;
+  auto check_index = [](int index, int count) {
+    if(index < 0 || index >= count)
+    {
+      throw RuntimeError("Invalid compiled tree: wrong index");
+    }
+  };
+
+  for(uint32_t i = 0; i < steps_count; i++)
+  {
+    switch(static_cast<StepKind>(reader.readByte()))
+    {
+      case StepKind::CREATE_BLACKBOARD: {
+        PImpl::CreateBlackboard step;
+        step.parent = reader.readInt();
+        check_index(step.parent, blackboards++);
+        step.autoremap = reader.readUInt() != 0;
+        const uint32_t ports_count = reader.readUInt();
+        for(uint32_t n = 0; n < ports_count; n++)
+        {
+          PImpl::CreateBlackboard::Port port;
+          port.name = reader.readString();
+          port.value = reader.readString();
+          port.is_constant = reader.readUInt() != 0;
+          step.ports.push_back(std::move(port));
+        }
+        p.steps.push_back(std::move(step));
+      }
+      break;
+
+      case StepKind::CREATE_ENTRY: {
+        PImpl::CreateEntry step;
+        step.blackboard = reader.readInt();
+        check_index(step.blackboard, blackboards);
+        step.key = reader.readString();
+        step.node_ID = reader.readString();
+        step.port_name = reader.readString();
+        const auto& ports = find_manifest(step.node_ID).ports;
+        auto port_it = ports.find(step.port_name);
+        if(port_it == ports.end())
+        {
+          throw RuntimeError("The compiled tree uses the port [", step.port_name,
+                             "] of the node [", step.node_ID,
+                             "], but the registered node doesn't have it");
+        }
+        step.info = port_it->second;
+        p.steps.push_back(std::move(step));
+      }
+      break;
+
+      case StepKind::CREATE_SUBTREE: {
+        PImpl::CreateSubtree step;
+        step.blackboard = reader.readInt();
+        check_index(step.blackboard, blackboards);
+        step.instance_name = reader.readString();
+        step.tree_ID = reader.readString();
+        subtrees++;
+        p.steps.push_back(std::move(step));
+      }
+      break;
+
+      case StepKind::CREATE_NODE: {
+        PImpl::CreateNode step;
+        step.name = reader.readString();
+        step.ID = reader.readString();
+        step.blackboard = reader.readInt();
+        check_index(step.blackboard, blackboards);
+        step.parent = reader.readInt();
+        if(step.parent != -1)
+        {
+          check_index(step.parent, int(p.steps.size()));
+          if(!std::holds_alternative<PImpl::CreateNode>(p.steps[step.parent]))
+          {
+            throw RuntimeError("Invalid compiled tree: wrong parent");
+          }
+        }
+        step.subtree = reader.readInt();
+        check_index(step.subtree, subtrees);
+        step.subtree_ID = reader.readString();
+        if(step.subtree_ID.empty())
+        {
+          find_manifest(step.ID);
+        }
+        auto& config = step.config;
+        const auto manifest_ID = reader.readString();
+        config.manifest = manifest_ID.empty() ? nullptr : &find_manifest(manifest_ID);
+        config.path = reader.readString();
+        config.uid = static_cast<uint16_t>(reader.readUInt());
+        config.input_ports = reader.readMap();
+        config.output_ports = reader.readMap();
+        config.other_attributes = reader.readMap();
+        config.pre_conditions = reader.readConditions<PreCond>();
+        config.post_conditions = reader.readConditions<PostCond>();
+        nodes++;
+        p.steps.push_back(std::move(step));
+      }
+      break;
+
+      default:
+        throw RuntimeError("Invalid compiled tree: unknown step");
+    }
+  }
+
+  if(!reader.atEnd() || blackboards != p.blackboards_count ||
+     subtrees != p.subtrees_count || nodes != p.nodes_count || subtrees == 0)
+  {
+    throw RuntimeError("Invalid compiled tree: inconsistent content");
+  }
+  p.snapshotManifests();
+  return tree_template;
+}
+
+namespace
+{
+// C++ string literal
+std::string CodeString(const std::string& str)
+{
+  std::string out = "\"";
+  for(char c : str)
+  {
+    switch(c)
+    {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20)
+        {
+          char octal[8];
+          snprintf(octal, sizeof(octal), "\\%03o", static_cast<unsigned char>(c));
+          out += octal;
+        }
+        else
+        {
+          out += c;
+        }
+    }
+  }
+  return out + "\"";
+}
 
-  for(auto bt_root = xml_root->FirstChildElement("BehaviorTree"); bt_root != nullptr;
-      bt_root = bt_root->NextSiblingElement("BehaviorTree"))
+std::string CodeMap(const std::unordered_map<std::string, std::string>& map)
+{
+  std::map<std::string, std::string> sorted(map.begin(), map.end());
+  std::string out = "{";
+  for(const auto& [key, value] : sorted)
   {
-    recursiveStep(bt_root);
+    out += (out.size() > 1 ? ", { " : " { ") + CodeString(key) + ", " +
+           CodeString(value) + " }";
   }
+  return out + (sorted.empty() ? "}" : " }");
 }
 
-Tree XMLParser::instantiateTree(const Blackboard::Ptr& root_blackboard,
-                                std::string main_tree_ID)
+const char* CodeCondition(PreCond cond)
 {
-  Tree output_tree;
+  static const char* names[] = { "PreCond::FAILURE_IF", "PreCond::SUCCESS_IF",
+                                 "PreCond::SKIP_IF", "PreCond::WHILE_TRUE" };
+  return names[int(cond)];
+}
 
-  // use the main_tree_to_execute argument if it was provided by the user
-  // or the one in the FIRST document opened
-  if(main_tree_ID.empty())
+const char* CodeCondition(PostCond cond)
+{
+  static const char* names[] = { "PostCond::ON_HALTED", "PostCond::ON_FAILURE",
+                                 "PostCond::ON_SUCCESS", "PostCond::ALWAYS" };
+  return names[int(cond)];
+}
+
+template <typename Cond>
+std::string CodeConditions(const std::map<Cond, std::string>& conditions)
+{
+  std::string out = "{";
+  for(const auto& [cond, script] : conditions)
   {
-    XMLElement* first_xml_root = _p->opened_documents.front()->RootElement();
+    out += (out.size() > 1 ? ", { " : " { ") + std::string(CodeCondition(cond)) + ", " +
+           CodeString(script) + " }";
+  }
+  return out + (conditions.empty() ? "}" : " }");
+}
 
-    if(auto main_tree_attribute = first_xml_root->Attribute("main_tree_to_execute"))
+}  // namespace
+
+std::string TreeTemplate::generateCode(const std::string& function_name) const
+{
+  std::ostringstream code;
+  code << "// Generated by bt4_codegen from the tree \"" << _p->tree_ID
+       << "\". Do not edit.\n"
+          "// It creates the same nodes as TreeTemplate::instantiate(), "
+          "without the XML.\n"
+          "#pragma once\n\n"
+          "#include \"behaviortree_cpp/bt_factory.h\"\n\n"
+          "inline BT::Tree "
+       << function_name
+       << "(const BT::BehaviorTreeFactory& factory,\n"
+          "    BT::Blackboard::Ptr blackboard = BT::Blackboard::create())\n"
+          "{\n"
+          "  using namespace BT;\n"
+          "  if(!blackboard)\n"
+          "  {\n"
+          "    throw RuntimeError(\""
+       << function_name
+       << " needs a non-empty blackboard\");\n"
+          "  }\n"
+          "  const auto& manifests = factory.manifests();\n"
+          "  Tree tree;\n"
+          "  Blackboard::Ptr bb["
+       << _p->blackboards_count
+       << "] = { blackboard };\n"
+          "  TreeNode* nodes["
+       << _p->nodes_count
+       << "] = {};\n\n"
+          "  // create the entry or check that it has the same type of the port\n"
+          "  auto create_entry = [](Blackboard& bb, const std::string& key,\n"
+          "                         const PortInfo& info) {\n"
+          "    if(auto prev = bb.entryInfo(key))\n"
+          "    {\n"
+          "      if(prev->isStronglyTyped() && info.isStronglyTyped() &&\n"
+          "         prev->type() != info.type() && prev->type() != typeid(std::string))\n"
+          "      {\n"
+          "        throw RuntimeError(\"The creation of the tree failed because the "
+          "port [\", key,\n"
+          "                           \"] was initially created with type [\", "
+          "demangle(prev->type()),\n"
+          "                           \"] and, later type [\", demangle(info.type()),\n"
+          "                           \"] was used somewhere else.\");\n"
+          "      }\n"
+          "    }\n"
+          "    else\n"
+          "    {\n"
+          "      bb.createEntry(key, info);\n"
+          "    }\n"
+          "  };\n\n"
+          "  auto add_node = [&tree](TreeNode::Ptr node, TreeNode* parent,\n"
+          "                           size_t subtree) {\n"
+          "    if(auto control = dynamic_cast<ControlNode*>(parent))\n"
+          "    {\n"
+          "      control->addChild(node.get());\n"
+          "    }\n"
+          "    else if(auto decorator = dynamic_cast<DecoratorNode*>(parent))\n"
+          "    {\n"
+          "      decorator->setChild(node.get());\n"
+          "    }\n"
+          "    TreeNode* ptr = node.get();\n"
+          "    tree.subtrees[subtree]->nodes.push_back(std::move(node));\n"
+          "    return ptr;\n"
+          "  };\n";
+
+  int blackboards = 1;
+  std::vector<int> node_number(_p->steps.size(), -1);
+  int nodes = 0;
+
+  for(size_t i = 0; i < _p->steps.size(); i++)
+  {
+    const auto& step = _p->steps[i];
+    if(auto create_bb = std::get_if<PImpl::CreateBlackboard>(&step))
     {
-      main_tree_ID = main_tree_attribute;
+      const std::string bb = "bb[" + std::to_string(blackboards++) + "]";
+      code << "\n  " << bb << " = Blackboard::create(bb[" << create_bb->parent << "]);\n"
+           << "  " << bb << "->enableAutoRemapping(" << std::boolalpha
+           << create_bb->autoremap << ");\n";
+      for(const auto& port : create_bb->ports)
+      {
+        if(port.is_constant)
+        {
+          code << "  " << bb << "->enableAutoRemapping(false);\n"
+               << "  " << bb << "->set(" << CodeString(port.name) << ", std::string("
+               << CodeString(port.value) << "));\n"
+               << "  " << bb << "->enableAutoRemapping(" << create_bb->autoremap
+               << ");\n";
+        }
+        else
+        {
+          code << "  " << bb << "->addSubtreeRemapping(" << CodeString(port.name) << ", "
+               << CodeString(port.value) << ");\n";
+        }
+      }
     }
-    else if(_p->tree_roots.size() == 1)
+    else if(auto create_entry = std::get_if<PImpl::CreateEntry>(&step))
     {
-      // special case: there is only one registered BT.
-      main_tree_ID = _p->tree_roots.begin()->first;
+      code << "  create_entry(*bb[" << create_entry->blackboard << "], "
+           << CodeString(create_entry->key) << ",\n"
+           << "               manifests.at(" << CodeString(create_entry->node_ID)
+           << ").ports.at(" << CodeString(create_entry->port_name) << "));\n";
     }
-    else
+    else if(auto create_subtree = std::get_if<PImpl::CreateSubtree>(&step))
     {
-      throw RuntimeError("[main_tree_to_execute] was not specified correctly");
+      code << "\n  // subtree " << CodeString(create_subtree->tree_ID) << "\n"
+           << "  {\n"
+           << "    auto subtree = std::make_shared<Tree::Subtree>();\n"
+           << "    subtree->blackboard = bb[" << create_subtree->blackboard << "];\n"
+           << "    subtree->instance_name = " << CodeString(create_subtree->instance_name)
+           << ";\n"
+           << "    subtree->tree_ID = " << CodeString(create_subtree->tree_ID) << ";\n"
+           << "    tree.subtrees.push_back(subtree);\n"
+           << "  }\n";
+    }
+    else if(auto create_node = std::get_if<PImpl::CreateNode>(&step))
+    {
+      const auto& config = create_node->config;
+      node_number[i] = nodes;
+      code << "  {\n"
+           << "    NodeConfig config;\n"
+           << "    config.blackboard = bb[" << create_node->blackboard << "];\n";
+      if(config.manifest)
+      {
+        code << "    config.manifest = &manifests.at("
+             << CodeString(config.manifest->registration_ID) << ");\n";
+      }
+      code << "    config.uid = tree.getUID();\n"
+           << "    config.path = " << CodeString(config.path) << ";\n";
+      if(!config.input_ports.empty())
+      {
+        code << "    config.input_ports = " << CodeMap(config.input_ports) << ";\n";
+      }
+      if(!config.output_ports.empty())
+      {
+        code << "    config.output_ports = " << CodeMap(config.output_ports) << ";\n";
+      }
+      if(!config.other_attributes.empty())
+      {
+        code << "    config.other_attributes = " << CodeMap(config.other_attributes)
+             << ";\n";
+      }
+      if(!config.pre_conditions.empty())
+      {
+        code << "    config.pre_conditions = " << CodeConditions(config.pre_conditions)
+             << ";\n";
+      }
+      if(!config.post_conditions.empty())
+      {
+        code << "    config.post_conditions = " << CodeConditions(config.post_conditions)
+             << ";\n";
+      }
+      code << "    auto node = factory.instantiateTreeNode("
+           << CodeString(create_node->name) << ", " << CodeString(create_node->ID)
+           << ", config);\n";
+      if(!create_node->subtree_ID.empty())
+      {
+        code << "    static_cast<SubTreeNode*>(node.get())->setSubtreeID("
+             << CodeString(create_node->subtree_ID) << ");\n";
+      }
+      const std::string parent =
+          create_node->parent < 0 ?
+              std::string("nullptr") :
+              "nodes[" + std::to_string(node_number[create_node->parent]) + "]";
+      code << "    nodes[" << nodes++ << "] = add_node(std::move(node), " << parent
+           << ", " << create_node->subtree << ");\n"
+           << "  }\n";
     }
   }
+  code << "\n  tree.initialize();\n"
+          "  tree.manifests = manifests;\n"
+          "  return tree;\n"
+          "}\n";
+  return code.str();
+}
 
-  //--------------------------------------
+Tree TreeTemplate::instantiate(Blackboard::Ptr root_blackboard) const
+{
   if(!root_blackboard)
   {
-    throw RuntimeError("XMLParser::instantiateTree needs a non-empty "
-                       "root_blackboard");
+    throw RuntimeError("TreeTemplate::instantiate needs a non-empty root_blackboard");
   }
 
-  _p->recursivelyCreateSubtree(main_tree_ID, {}, {}, output_tree, root_blackboard,
-                               TreeNode::Ptr());
-  output_tree.initialize();
-  return output_tree;
+  Tree tree;
+  std::vector<Blackboard::Ptr> blackboards(size_t(_p->blackboards_count));
+  blackboards[0] = root_blackboard;
+  // indexed like the steps
+  std::vector<TreeNode*> nodes(_p->steps.size(), nullptr);
+  int blackboards_count = 1;
+
+  for(size_t i = 0; i < _p->steps.size(); i++)
+  {
+    const auto& step = _p->steps[i];
+    if(auto create_bb = std::get_if<PImpl::CreateBlackboard>(&step))
+    {
+      auto new_bb = Blackboard::create(blackboards[create_bb->parent]);
+      new_bb->enableAutoRemapping(create_bb->autoremap);
+      for(const auto& port : create_bb->ports)
+      {
+        if(port.is_constant)
+        {
+          new_bb->enableAutoRemapping(false);
+          new_bb->set(port.name, port.value);
+          new_bb->enableAutoRemapping(create_bb->autoremap);
+        }
+        else
+        {
+          new_bb->addSubtreeRemapping(port.name, port.value);
+        }
+      }
+      blackboards[blackboards_count++] = new_bb;
+    }
+    else if(auto create_entry = std::get_if<PImpl::CreateEntry>(&step))
+    {
+      CreatePortEntry(*blackboards[create_entry->blackboard], create_entry->key,
+                      create_entry->info);
+    }
+    else if(auto create_subtree = std::get_if<PImpl::CreateSubtree>(&step))
+    {
+      auto new_tree = std::make_shared<Tree::Subtree>();
+      new_tree->blackboard = blackboards[create_subtree->blackboard];
+      new_tree->instance_name = create_subtree->instance_name;
+      new_tree->tree_ID = create_subtree->tree_ID;
+      tree.subtrees.push_back(std::move(new_tree));
+    }
+    else if(auto create_node = std::get_if<PImpl::CreateNode>(&step))
+    {
+      NodeConfig config = create_node->config;
+      config.blackboard = blackboards[create_node->blackboard];
+      config.uid = tree.getUID();
+
+      TreeNode::Ptr node =
+          _p->factory->instantiateTreeNode(create_node->name, create_node->ID, config);
+      if(!create_node->subtree_ID.empty())
+      {
+        static_cast<SubTreeNode*>(node.get())->setSubtreeID(create_node->subtree_ID);
+      }
+      if(create_node->parent >= 0)
+      {
+        auto parent = nodes[create_node->parent];
+        if(auto control_parent = dynamic_cast<ControlNode*>(parent))
+        {
+          control_parent->addChild(node.get());
+        }
+        else if(auto decorator_parent = dynamic_cast<DecoratorNode*>(parent))
+        {
+          decorator_parent->setChild(node.get());
+        }
+      }
+      nodes[i] = node.get();
+      tree.subtrees[create_node->subtree]->nodes.push_back(std::move(node));
+    }
+  }
+
+  tree.initialize();
+  if(_p->manifests)
+  {
+    tree.manifests = *_p->manifests;
+  }
+  return tree;
 }
 
 void XMLParser::clearInternalState()
@@ -674,11 +1769,9 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
 
   const TreeNodeManifest* manifest = nullptr;
 
-  auto manifest_it = factory.manifests().find(type_ID);
-  if(manifest_it != factory.manifests().end())
-  {
-    manifest = &manifest_it->second;
-  }
+  // the real manifest is needed, with the types of the ports
+  factory.loadDeferredPlugin(type_ID);
+  manifest = factory.findManifest(type_ID);
 
   PortsRemapping port_remap;
   NonPortAttributes other_attributes;
@@ -815,31 +1908,12 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
         // port_key will contain the key to find the entry in the blackboard
         const auto port_key = static_cast<std::string>(param_res.value());
 
-        // if the entry already exists, check that the type is the same
-        if(auto prev_info = blackboard->entryInfo(port_key))
-        {
-          // Check consistency of types.
-          bool const port_type_mismatch =
-              (prev_info->isStronglyTyped() && port_info.isStronglyTyped() &&
-               prev_info->type() != port_info.type());
-
-          // special case related to convertFromString
-          bool const string_input = (prev_info->type() == typeid(std::string));
-
-          if(port_type_mismatch && !string_input)
-          {
-            blackboard->debugMessage();
-
-            throw RuntimeError("The creation of the tree failed because the port [",
-                               port_key, "] was initially created with type [",
-                               demangle(prev_info->type()), "] and, later type [",
-                               demangle(port_info.type()), "] was used somewhere else.");
-          }
-        }
-        else
+        CreatePortEntry(*blackboard, port_key, port_info);
+        if(recorder)
         {
-          // not found, insert for the first time.
-          blackboard->createEntry(port_key, port_info);
+          recorder->steps.push_back(TreeTemplate::PImpl::CreateEntry{
+              recorder->blackboard_index.at(blackboard.get()), port_key, port_info,
+              type_ID, port_name });
         }
       }
     }
@@ -890,6 +1964,25 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
     new_node = factory.instantiateTreeNode(instance_name, type_ID, config);
   }
 
+  if(recorder)
+  {
+    TreeTemplate::PImpl::CreateNode step;
+    step.name = instance_name;
+    step.ID = (node_type == NodeType::SUBTREE) ? toStr(NodeType::SUBTREE) : type_ID;
+    step.config = config;
+    step.config.blackboard.reset();
+    step.blackboard = recorder->blackboard_index.at(blackboard.get());
+    step.parent = node_parent ? recorder->node_index.at(node_parent.get()) : -1;
+    step.subtree = -1;
+    if(node_type == NodeType::SUBTREE)
+    {
+      step.subtree_ID = type_ID;
+    }
+    recorder->node_index[new_node.get()] = int(recorder->steps.size());
+    recorder->steps.push_back(std::move(step));
+    recorder->nodes_count++;
+  }
+
   // add the pointer of this node to the parent
   if(node_parent != nullptr)
   {
@@ -922,6 +2015,12 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(const std::string& tree_ID,
     // create the node
     auto node = createNodeFromXML(element, blackboard, parent_node, prefix, output_tree);
     subtree->nodes.push_back(node);
+    if(recorder)
+    {
+      auto& step = std::get<TreeTemplate::PImpl::CreateNode>(
+          recorder->steps[recorder->node_index.at(node.get())]);
+      step.subtree = recorder->subtree_index.at(subtree.get());
+    }
 
     // common case: iterate through all children
     if(node->type() != NodeType::SUBTREE)
@@ -938,6 +2037,7 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(const std::string& tree_ID,
       const std::string subtree_ID = element->Attribute("ID");
       std::unordered_map<std::string, std::string> subtree_remapping;
       bool do_autoremap = false;
+      bool is_lazy = false;
 
       for(auto attr = element->FirstAttribute(); attr != nullptr; attr = attr->Next())
       {
@@ -954,6 +2054,11 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(const std::string& tree_ID,
           new_bb->enableAutoRemapping(do_autoremap);
           continue;
         }
+        if(attr_name == "_lazy")
+        {
+          is_lazy = convertFromString<bool>(attr_value);
+          continue;
+        }
         if(!IsAllowedPortName(attr->Name()))
         {
           continue;
@@ -992,6 +2097,27 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(const std::string& tree_ID,
         }
       }
 
+      if(recorder)
+      {
+        TreeTemplate::PImpl::CreateBlackboard step;
+        step.parent = recorder->blackboard_index.at(blackboard.get());
+        step.autoremap = do_autoremap;
+        for(const auto& [attr_name, attr_value] : subtree_remapping)
+        {
+          if(TreeNode::isBlackboardPointer(attr_value))
+          {
+            auto port_name = TreeNode::stripBlackboardPointer(attr_value);
+            step.ports.push_back({ attr_name, std::string(port_name), false });
+          }
+          else
+          {
+            step.ports.push_back({ attr_name, attr_value, true });
+          }
+        }
+        recorder->blackboard_index[new_bb.get()] = recorder->blackboards_count++;
+        recorder->steps.push_back(std::move(step));
+      }
+
       for(const auto& [attr_name, attr_value] : subtree_remapping)
       {
         if(TreeNode::isBlackboardPointer(attr_value))
@@ -1024,6 +2150,35 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(const std::string& tree_ID,
         subtree_path += subtree_ID + "::" + std::to_string(node->UID());
       }
 
+      // A TreeTemplate records all the nodes, therefore it ignores _lazy
+      if(is_lazy && !recorder)
+      {
+        if(tree_roots.count(subtree_ID) == 0)
+        {
+          throw RuntimeError("Can't find a tree with name: ", subtree_ID);
+        }
+        // reserve the UIDs of the nodes of the subtree
+        const uint16_t last_uid = node->UID();
+        for(size_t i = 0; i < countNodes(subtree_ID); i++)
+        {
+          static_cast<void>(output_tree.getUID());
+        }
+
+        auto builder = [snapshot = lazySnapshot(), subtree_ID, subtree_path, new_bb,
+                        last_uid](SubTreeNode& subtree_node, Tree& lazy_tree) {
+          for(uint16_t i = 0; i < last_uid; i++)
+          {
+            static_cast<void>(lazy_tree.getUID());
+          }
+          // not owned by the lazy tree
+          TreeNode::Ptr parent(&subtree_node, [](TreeNode*) {});
+          snapshot->recursivelyCreateSubtree(subtree_ID, subtree_path, subtree_path + "/",
+                                             lazy_tree, new_bb, parent);
+        };
+        static_cast<SubTreeNode*>(node.get())->setLazyBuilder(std::move(builder));
+        return;
+      }
+
       recursivelyCreateSubtree(subtree_ID,
                                subtree_path,        // name
                                subtree_path + "/",  //prefix
@@ -1048,9 +2203,53 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(const std::string& tree_ID,
   new_tree->tree_ID = tree_ID;
   output_tree.subtrees.push_back(new_tree);
 
+  if(recorder)
+  {
+    recorder->subtree_index[new_tree.get()] = recorder->subtrees_count++;
+    recorder->steps.push_back(TreeTemplate::PImpl::CreateSubtree{
+        recorder->blackboard_index.at(blackboard.get()), tree_path, tree_ID });
+  }
+
   recursiveStep(root_node, new_tree, prefix_path, root_element);
 }
 
+size_t XMLParser::PImpl::countNodes(const std::string& tree_ID)
+{
+  if(auto it = nodes_count.find(tree_ID); it != nodes_count.end())
+  {
+    return it->second;
+  }
+  auto root_it = tree_roots.find(tree_ID);
+  if(root_it == tree_roots.end())
+  {
+    throw RuntimeError("Can't find a tree with name: ", tree_ID);
+  }
+
+  size_t count = 0;
+  std::function<void(const XMLElement*)> recursiveStep;
+  recursiveStep = [&](const XMLElement* element) {
+    count++;
+    if(StrEqual(element->Name(), "SubTree"))
+    {
+      auto subtree_ID = element->Attribute("ID");
+      if(!subtree_ID)
+      {
+        throw RuntimeError("Attribute [ID] is mandatory in <SubTree>");
+      }
+      count += countNodes(subtree_ID);
+      return;
+    }
+    for(auto child = element->FirstChildElement(); child;
+        child = child->NextSiblingElement())
+    {
+      recursiveStep(child);
+    }
+  };
+  recursiveStep(root_it->second->FirstChildElement());
+  nodes_count[tree_ID] = count;
+  return count;
+}
+
 void XMLParser::PImpl::getPortsRecursively(const XMLElement* element,
                                            std::vector<std::string>& output_ports)
 {
@@ -1180,20 +2379,14 @@ void addTreeToXML(const Tree& tree, XMLDocument& doc, XMLElement* rootXML,
 
     parent_elem->InsertEndChild(elem);
 
-    if(auto control = dynamic_cast<const ControlNode*>(&node))
+    // the nodes of a SubTree are added to its own BehaviorTree element
+    if(node.type() != NodeType::SUBTREE)
     {
-      for(const auto& child : control->children())
+      for(const TreeNode* child : node.children())
       {
         addNode(*child, elem);
       }
     }
-    else if(auto decorator = dynamic_cast<const DecoratorNode*>(&node))
-    {
-      if(decorator->type() != NodeType::SUBTREE)
-      {
-        addNode(*decorator->child(), elem);
-      }
-    }
   };
 
   for(const auto& subtree : tree.subtrees)
@@ -1225,11 +2418,12 @@ void addTreeToXML(const Tree& tree, XMLDocument& doc, XMLElement* rootXML,
   }
 }
 
-std::string writeTreeNodesModelXML(const BehaviorTreeFactory& factory,
-                                   bool include_builtin)
+namespace
+{
+// the <TreeNodesModel> of writeTreeNodesModelXML()
+XMLElement* AddTreeNodesModelToXML(const BehaviorTreeFactory& factory,
+                                   bool include_builtin, XMLDocument& doc)
 {
-  XMLDocument doc;
-
   XMLElement* rootXML = doc.NewElement("root");
   rootXML->SetAttribute("BTCPP_format", "4");
   doc.InsertFirstChild(rootXML);
@@ -1251,12 +2445,163 @@ std::string writeTreeNodesModelXML(const BehaviorTreeFactory& factory,
   {
     addNodeModelToXML(*model, doc, model_root);
   }
+  return rootXML;
+}
+}  // namespace
+
+std::string writeTreeNodesModelXML(const BehaviorTreeFactory& factory,
+                                   bool include_builtin)
+{
+  XMLDocument doc;
+  AddTreeNodesModelToXML(factory, include_builtin, doc);
+
+  XMLPrinter printer;
+  doc.Print(&printer);
+  return std::string(printer.CStr(), size_t(printer.CStrSize() - 1));
+}
+
+std::string writePluginManifestXML(const BehaviorTreeFactory& factory)
+{
+  XMLDocument doc;
+  XMLElement* rootXML = AddTreeNodesModelToXML(factory, false, doc);
+
+  XMLElement* enums_root = doc.NewElement("ScriptingEnums");
+  rootXML->InsertEndChild(enums_root);
+  const std::map<std::string, int> ordered_enums(factory.scriptingEnums().begin(),
+                                                 factory.scriptingEnums().end());
+  for(const auto& [name, value] : ordered_enums)
+  {
+    XMLElement* enum_element = doc.NewElement("Enum");
+    enum_element->SetAttribute("name", name.c_str());
+    enum_element->SetAttribute("value", value);
+    enums_root->InsertEndChild(enum_element);
+  }
 
   XMLPrinter printer;
   doc.Print(&printer);
   return std::string(printer.CStr(), size_t(printer.CStrSize() - 1));
 }
 
+std::vector<std::pair<std::string, int>>
+readScriptingEnumsXML(const std::string& xml_text)
+{
+  XMLDocument doc;
+  doc.Parse(xml_text.c_str(), xml_text.size());
+  if(doc.Error())
+  {
+    throw RuntimeError("Error parsing the XML: ", doc.ErrorStr());
+  }
+  const XMLElement* xml_root = doc.RootElement();
+  if(!xml_root)
+  {
+    throw RuntimeError("Invalid XML: missing root element");
+  }
+
+  std::vector<std::pair<std::string, int>> enums;
+  for(auto enums_node = xml_root->FirstChildElement("ScriptingEnums");
+      enums_node != nullptr;
+      enums_node = enums_node->NextSiblingElement("ScriptingEnums"))
+  {
+    for(auto enum_node = enums_node->FirstChildElement("Enum"); enum_node != nullptr;
+        enum_node = enum_node->NextSiblingElement("Enum"))
+    {
+      const char* name = enum_node->Attribute("name");
+      int value = 0;
+      if(!name || enum_node->QueryIntAttribute("value", &value) != XML_SUCCESS)
+      {
+        throw RuntimeError("Invalid <Enum> in ScriptingEnums: it needs the attributes "
+                           "[name] and [value]");
+      }
+      enums.push_back({ name, value });
+    }
+  }
+  return enums;
+}
+
+std::vector<TreeNodeManifest> readTreeNodesModelXML(const std::string& xml_text)
+{
+  XMLDocument doc;
+  doc.Parse(xml_text.c_str(), xml_text.size());
+  if(doc.Error())
+  {
+    throw RuntimeError("Error parsing the XML: ", doc.ErrorStr());
+  }
+  const XMLElement* xml_root = doc.RootElement();
+  if(!xml_root)
+  {
+    throw RuntimeError("Invalid XML: missing root element");
+  }
+
+  std::vector<TreeNodeManifest> manifests;
+  for(auto models_node = xml_root->FirstChildElement("TreeNodesModel");
+      models_node != nullptr;
+      models_node = models_node->NextSiblingElement("TreeNodesModel"))
+  {
+    for(auto node = models_node->FirstChildElement(); node != nullptr;
+        node = node->NextSiblingElement())
+    {
+      TreeNodeManifest manifest;
+      manifest.type = convertFromString<NodeType>(node->Name());
+      if(manifest.type == NodeType::SUBTREE)
+      {
+        continue;
+      }
+      if(manifest.type == NodeType::UNDEFINED)
+      {
+        throw RuntimeError("Invalid node type <", node->Name(), "> in TreeNodesModel");
+      }
+      auto ID = node->Attribute("ID");
+      if(!ID)
+      {
+        throw RuntimeError("Missing attribute [ID] in TreeNodesModel");
+      }
+      manifest.registration_ID = ID;
+
+      std::pair<const char*, BT::PortDirection> port_types[3] = {
+        { "input_port", BT::PortDirection::INPUT },
+        { "output_port", BT::PortDirection::OUTPUT },
+        { "inout_port", BT::PortDirection::INOUT }
+      };
+      for(const auto& [name, direction] : port_types)
+      {
+        for(auto port_node = node->FirstChildElement(name); port_node != nullptr;
+            port_node = port_node->NextSiblingElement(name))
+        {
+          auto port_name = port_node->Attribute("name");
+          if(!port_name)
+          {
+            throw RuntimeError("Missing attribute [name] in port of [", ID, "]");
+          }
+          BT::PortInfo port(direction);
+          if(auto default_value = port_node->Attribute("default"))
+          {
+            port.setDefaultValue(default_value);
+          }
+          if(auto description = port_node->GetText())
+          {
+            port.setDescription(description);
+          }
+          manifest.ports[port_name] = std::move(port);
+        }
+      }
+
+      if(auto metadata_root = node->FirstChildElement("MetadataFields"))
+      {
+        for(auto metadata = metadata_root->FirstChildElement("Metadata");
+            metadata != nullptr; metadata = metadata->NextSiblingElement("Metadata"))
+        {
+          for(auto attr = metadata->FirstAttribute(); attr; attr = attr->Next())
+          {
+            manifest.metadata.emplace_back(attr->Name(), attr->Value());
+          }
+        }
+      }
+      manifests.push_back(std::move(manifest));
+    }
+  }
+  return manifests;
+}
+
 std::string writeTreeXSD(const BehaviorTreeFactory& factory)
 {
   // There are 2 forms of representation for a node:
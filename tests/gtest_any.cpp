@@ -250,3 +250,84 @@ TEST(Any, Cast)
     EXPECT_EQ(a.cast<std::vector<int>>(), v);
   }
 }
+
+TEST(Any, CopyAndMove)
+{
+  // the destination keeps its type
+  {
+    Any src(42);
+    Any dst(1.5);
+    src.copyInto(dst);
+    EXPECT_EQ(dst.castedType(), typeid(double));
+    EXPECT_EQ(dst.cast<double>(), 42.0);
+
+    Any str(std::string("hello"));
+    EXPECT_ANY_THROW(str.copyInto(dst));
+
+    std::vector<int> v{ 1, 2, 3 };
+    Any vect_src(v);
+    Any vect_dst(std::vector<int>{});
+    vect_src.copyInto(vect_dst);
+    EXPECT_EQ(vect_dst.cast<std::vector<int>>(), v);
+    EXPECT_ANY_THROW(vect_src.copyInto(dst));
+  }
+
+  // a moved Any is empty
+  {
+    Any a(std::string("a string longer than the small buffer of SimpleString"));
+    Any b(std::move(a));
+    EXPECT_TRUE(a.empty());
+    EXPECT_FALSE(a.isString());
+    EXPECT_TRUE(b.isString());
+
+    Any c;
+    c = std::move(b);
+    EXPECT_TRUE(b.empty());
+    EXPECT_FALSE(b.isString());
+    EXPECT_EQ(c.cast<std::string>(),
+              "a string longer than the small buffer of SimpleString");
+  }
+}
+
+TEST(Any, SharedStrings)
+{
+  using SafeAny::SimpleString;
+  const std::string long_str = "this string is too long for the small buffer";
+
+  SimpleString a(long_str);
+  SimpleString b = a;
+  // copies share the same buffer
+  EXPECT_EQ(a.data(), b.data());
+  EXPECT_TRUE(a.sharesBufferWith(b));
+  EXPECT_TRUE(a == b);
+  EXPECT_FALSE(a != b);
+
+  SimpleString c(long_str);
+  EXPECT_FALSE(a.sharesBufferWith(c));
+  EXPECT_TRUE(a == c);
+
+  // the buffer is released only when the last copy is destroyed
+  {
+    SimpleString d(std::string("another long string, allocated on the heap"));
+    b = d;
+    d = a;
+  }
+  EXPECT_EQ(b.toStdString(), "another long string, allocated on the heap");
+  EXPECT_EQ(a.toStdString(), long_str);
+
+  b = b;
+  EXPECT_EQ(b.toStdString(), "another long string, allocated on the heap");
+
+  // short strings are stored in place
+  SimpleString e("short");
+  SimpleString f = e;
+  EXPECT_NE(e.data(), f.data());
+  EXPECT_TRUE(e == f);
+  EXPECT_TRUE(e < a);
+
+  // same in Any
+  Any any_a(long_str);
+  Any any_b = any_a;
+  EXPECT_EQ(any_a.cast<SimpleString>().data(), any_b.cast<SimpleString>().data());
+  EXPECT_EQ(any_b.cast<std::string>(), long_str);
+}
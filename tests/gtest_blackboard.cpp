@@ -11,6 +11,8 @@
 */
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 #include "behaviortree_cpp/bt_factory.h"
 #include "behaviortree_cpp/blackboard.h"
 
@@ -854,3 +856,110 @@ TEST(BlackboardTest, SetBlackboard_WithPortRemapping)
   // Tick till the end with no crashes
   ASSERT_NO_THROW(tree.tickWhileRunning(););
 }
+
+TEST(BlackboardTest, MailboxEntries)
+{
+  BehaviorTreeFactory factory;
+
+  const std::string xml_text = R"(
+    <root BTCPP_format="4" >
+      <BehaviorTree ID="MainTree">
+        <Sequence>
+          <Script code="copy := value" />
+          <Sleep msec="20" />
+          <Script code="copy = value" />
+        </Sequence>
+      </BehaviorTree>
+    </root>
+  )";
+
+  auto bb = Blackboard::create();
+  bb->set("value", 1);
+  ASSERT_ANY_THROW(bb->post("value", 2));
+  bb->enableMailbox("value");
+  // calling it twice is not an error
+  bb->enableMailbox("value");
+  ASSERT_ANY_THROW(bb->post("value", std::string("hello")));
+
+  auto tree = factory.createTreeFromText(xml_text, bb);
+
+  // not visible until the next tick
+  bb->post("value", 2);
+  ASSERT_EQ(bb->get<int>("value"), 1);
+
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(bb->get<int>("value"), 2);
+  ASSERT_EQ(bb->get<int>("copy"), 2);
+
+  // only the latest value is committed
+  bb->post("value", 3);
+  bb->post("value", 4);
+  ASSERT_EQ(bb->get<int>("value"), 2);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::SUCCESS);
+  ASSERT_EQ(bb->get<int>("value"), 4);
+  ASSERT_EQ(bb->get<int>("copy"), 4);
+
+  // nothing pending
+  ASSERT_EQ(bb->commitMailboxes(), 0);
+}
+
+TEST(BlackboardTest, MailboxFromOtherThread)
+{
+  auto bb = Blackboard::create();
+  bb->set("counter", 0);
+  bb->enableMailbox("counter");
+
+  std::atomic_bool done = false;
+  std::thread producer([&]() {
+    for(int i = 1; i <= 1000; i++)
+    {
+      bb->post("counter", i);
+    }
+    done = true;
+  });
+
+  int prev = 0;
+  while(!done)
+  {
+    bb->commitMailboxes();
+    const int value = bb->get<int>("counter");
+    // values are committed in the same order they are posted
+    ASSERT_GE(value, prev);
+    prev = value;
+  }
+  producer.join();
+  bb->commitMailboxes();
+  ASSERT_EQ(bb->get<int>("counter"), 1000);
+}
+
+TEST(BlackboardTest, MailboxManyProducers)
+{
+  auto bb = Blackboard::create();
+  bb->set("value", 0);
+  bb->enableMailbox("value");
+
+  std::vector<std::thread> producers;
+  for(int p = 0; p < 4; p++)
+  {
+    producers.emplace_back([&bb, p]() {
+      for(int i = 1; i <= 1000; i++)
+      {
+        bb->post("value", p * 10000 + i);
+      }
+    });
+  }
+  for(int i = 0; i < 100; i++)
+  {
+    bb->commitMailboxes();
+  }
+  for(auto& producer : producers)
+  {
+    producer.join();
+  }
+  bb->commitMailboxes();
+  // the last value posted by one of the producers
+  ASSERT_EQ(bb->get<int>("value") % 10000, 1000);
+  ASSERT_EQ(bb->commitMailboxes(), 0);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/loggers/abstract_logger.h"
+
+// Generated from trees/codegen_tree.xml with:
+//   bt4_codegen --function CreateCodegenTree
+//               trees/codegen_tree.xml include/codegen_tree.hpp
+#include "codegen_tree.hpp"
+
+using namespace BT;
+
+std::string FilePath(const std::filesystem::path& relative_path);
+
+namespace
+{
+// Sequence of all the status transitions
+class TraceLogger : public StatusChangeLogger
+{
+public:
+  explicit TraceLogger(const Tree& tree) : StatusChangeLogger(tree.rootNode())
+  {}
+
+  void flush() override
+  {}
+
+  std::vector<std::string> trace;
+
+private:
+  void callback(Duration, const TreeNode& node, NodeStatus prev_status,
+                NodeStatus status) override
+  {
+    trace.push_back(node.fullPath() + " " + toStr(prev_status) + "->" + toStr(status));
+  }
+};
+
+std::string EntryToString(const Blackboard& blackboard, const std::string& key)
+{
+  auto entry = blackboard.getEntry(key);
+  if(!entry)
+  {
+    return "<missing>";
+  }
+  const auto& value = entry->value;
+  if(value.empty())
+  {
+    return "<empty>";
+  }
+  if(value.isString())
+  {
+    return value.cast<std::string>();
+  }
+  if(value.isNumber())
+  {
+    return std::to_string(value.cast<double>());
+  }
+  return demangle(value.type());
+}
+
+std::string ReadFile(const std::string& path)
+{
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+}  // namespace
+
+TEST(Codegen, GeneratedCodeIsUpToDate)
+{
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromFile(FilePath("trees/codegen_tree.xml"));
+  auto code = factory.compileTree("CodegenTree")->generateCode("CreateCodegenTree");
+
+  const auto expected = ReadFile(FilePath("include/codegen_tree.hpp"));
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(code, expected) << "Generate include/codegen_tree.hpp again with "
+                               "bt4_codegen";
+}
+
+// The generated code and the interpreted tree must behave in the same way
+TEST(Codegen, DifferentialTest)
+{
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromFile(FilePath("trees/codegen_tree.xml"));
+
+  const std::vector<std::string> keys = { "count",  "total",    "result",
+                                          "report", "finished", "stop" };
+
+  for(int cycles : { 0, 1, 3, 12 })
+  {
+    for(int limit : { 0, 5, 50 })
+    {
+      for(bool stop : { false, true })
+      {
+        auto CreateBlackboard = [&]() {
+          auto blackboard = Blackboard::create();
+          blackboard->set("cycles", cycles);
+          blackboard->set("limit", limit);
+          blackboard->set("stop", stop);
+          blackboard->set("result", std::string("none"));
+          return blackboard;
+        };
+
+        auto interpreted = factory.createTree("CodegenTree", CreateBlackboard());
+        auto generated = CreateCodegenTree(factory, CreateBlackboard());
+
+        TraceLogger interpreted_trace(interpreted);
+        TraceLogger generated_trace(generated);
+
+        for(int tick = 0; tick < 3; tick++)
+        {
+          ASSERT_EQ(interpreted.tickOnce(), generated.tickOnce());
+        }
+        ASSERT_FALSE(interpreted_trace.trace.empty());
+        ASSERT_EQ(interpreted_trace.trace, generated_trace.trace);
+
+        for(size_t i = 0; i < interpreted.subtrees.size(); i++)
+        {
+          for(const auto& key : keys)
+          {
+            ASSERT_EQ(EntryToString(*interpreted.subtrees[i]->blackboard, key),
+                      EntryToString(*generated.subtrees[i]->blackboard, key));
+          }
+        }
+      }
+    }
+  }
+}
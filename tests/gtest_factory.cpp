@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <filesystem>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include "behaviortree_cpp/xml_parsing.h"
@@ -396,6 +398,405 @@ TEST(BehaviorTreeReload, ReloadSameTree)
   }
 }
 
+TEST(BehaviorTreeFactory, CompileTree)
+{
+  const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" counter:=0; cycles:=1 " />
+      <Repeat num_cycles="{cycles}">
+        <SubTree ID="Increment" value="{counter}" times="2" />
+      </Repeat>
+      <SubTree ID="Increment" name="second" value="{counter}" times="3" />
+      <SubTree ID="Check" _autoremap="true" />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Repeat num_cycles="{times}">
+      <Script code=" value += 1 " />
+    </Repeat>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Check">
+    <ScriptCondition code=" counter == 5 " />
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  auto tree_template = factory.compileTree("MainTree");
+  ASSERT_EQ(tree_template->treeID(), "MainTree");
+
+  auto expected = factory.createTree("MainTree");
+  ASSERT_EQ(tree_template->nodesCount(), 11);
+
+  std::vector<Tree> trees;
+  for(int i = 0; i < 2; i++)
+  {
+    trees.push_back(tree_template->instantiate());
+  }
+
+  for(auto& tree : trees)
+  {
+    ASSERT_EQ(tree.subtrees.size(), expected.subtrees.size());
+    for(size_t i = 0; i < tree.subtrees.size(); i++)
+    {
+      const auto& subtree = tree.subtrees[i];
+      const auto& expected_subtree = expected.subtrees[i];
+      ASSERT_EQ(subtree->instance_name, expected_subtree->instance_name);
+      ASSERT_EQ(subtree->tree_ID, expected_subtree->tree_ID);
+      ASSERT_EQ(subtree->nodes.size(), expected_subtree->nodes.size());
+      for(size_t n = 0; n < subtree->nodes.size(); n++)
+      {
+        ASSERT_EQ(subtree->nodes[n]->fullPath(), expected_subtree->nodes[n]->fullPath());
+        ASSERT_EQ(subtree->nodes[n]->UID(), expected_subtree->nodes[n]->UID());
+      }
+    }
+  }
+  // only the manifests of the node types of the tree
+  ASSERT_EQ(trees.front().manifests.count("ScriptCondition"), 1);
+  ASSERT_EQ(trees.front().manifests.count("Sleep"), 0);
+
+  // each instance has its own blackboards
+  ASSERT_EQ(NodeStatus::SUCCESS, trees[0].tickWhileRunning());
+  ASSERT_EQ(trees[0].rootBlackboard()->get<int>("counter"), 5);
+  ASSERT_FALSE(trees[1].rootBlackboard()->getEntry("counter"));
+  ASSERT_EQ(NodeStatus::SUCCESS, trees[1].tickWhileRunning());
+  ASSERT_EQ(trees[1].rootBlackboard()->get<int>("counter"), 5);
+
+  // the types of the entries are checked like createTree() does
+  auto blackboard = Blackboard::create();
+  blackboard->set("cycles", std::vector<int>{});
+  EXPECT_ANY_THROW(auto tree = factory.createTree("MainTree", blackboard));
+  EXPECT_ANY_THROW(auto tree = tree_template->instantiate(blackboard));
+
+  EXPECT_ANY_THROW(factory.compileTree("Wrong Name"));
+}
+
+TEST(BehaviorTreeFactory, CompiledTreeSerialization)
+{
+  const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" msg:='hello'; skip:=false " />
+      <SaySomething message="{msg}" _skipIf="skip" />
+      <SubTree ID="Child" text="{msg}" constant="42" />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Child">
+    <Sequence>
+      <SaySomething message="{text}" />
+      <ScriptCondition code=" constant == '42' " _onSuccess="done:=true" />
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<DummyNodes::SaySomething>("SaySomething");
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  const auto buffer = factory.compileTree("MainTree")->serialize();
+  // the content doesn't depend on the order of the hash maps
+  ASSERT_EQ(buffer, factory.compileTree("MainTree")->serialize());
+
+  // a different factory, that never parsed the XML
+  BehaviorTreeFactory other_factory;
+  other_factory.registerNodeType<DummyNodes::SaySomething>("SaySomething");
+  auto tree_template = TreeTemplate::deserialize(other_factory, buffer.data(),
+                                                 buffer.size());
+  ASSERT_EQ(tree_template->serialize(), buffer);
+  ASSERT_EQ(tree_template->treeID(), "MainTree");
+
+  auto expected = factory.createTree("MainTree");
+  auto tree = tree_template->instantiate();
+  ASSERT_EQ(tree.subtrees.size(), expected.subtrees.size());
+  for(size_t i = 0; i < tree.subtrees.size(); i++)
+  {
+    ASSERT_EQ(tree.subtrees[i]->nodes.size(), expected.subtrees[i]->nodes.size());
+    for(size_t n = 0; n < tree.subtrees[i]->nodes.size(); n++)
+    {
+      ASSERT_EQ(tree.subtrees[i]->nodes[n]->fullPath(),
+                expected.subtrees[i]->nodes[n]->fullPath());
+    }
+  }
+  ASSERT_EQ(NodeStatus::SUCCESS, tree.tickWhileRunning());
+  ASSERT_TRUE(tree.subtrees[1]->blackboard->get<bool>("done"));
+
+  // truncated buffer and wrong version
+  EXPECT_THROW(auto t = TreeTemplate::deserialize(other_factory, buffer.data(),
+                                                  buffer.size() - 1),
+               RuntimeError);
+  auto wrong_version = buffer;
+  wrong_version[4] = char(TreeTemplate::BINARY_FORMAT_VERSION + 1);
+  EXPECT_THROW(auto t = TreeTemplate::deserialize(other_factory, wrong_version.data(),
+                                                  wrong_version.size()),
+               RuntimeError);
+
+  // the nodes must be registered
+  BehaviorTreeFactory empty_factory;
+  EXPECT_THROW(auto t = TreeTemplate::deserialize(empty_factory, buffer.data(),
+                                                  buffer.size()),
+               RuntimeError);
+}
+
+TEST(BehaviorTreeFactory, CompiledRegistryMultithread)
+{
+  const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" counter:=0; color:=RED " />
+      <SubTree ID="Increment" value="{counter}" times="3" />
+      <ScriptCondition code=" counter == 3 &amp;&amp; color == RED " />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Repeat num_cycles="{times}">
+      <Script code=" value += 1 " />
+    </Repeat>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerScriptingEnum("RED", 42);
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  auto registry = factory.compileRegistry();
+  ASSERT_EQ(registry->registeredBehaviorTrees().size(), 2);
+  EXPECT_THROW(auto t = registry->createTree("Unknown"), RuntimeError);
+
+  // the registry is not affected by the changes applied to the factory
+  factory.clearRegisteredBehaviorTrees();
+  factory.registerScriptingEnum("GREEN", 43);
+  TestNodeConfig failure;
+  failure.return_status = NodeStatus::FAILURE;
+  factory.addSubstitutionRule("*", failure);
+  ASSERT_EQ(registry->factory().substitutionRules().size(), 0);
+
+  constexpr int THREADS = 4;
+  constexpr int TREES_PER_THREAD = 25;
+  std::atomic_int success_count = 0;
+  std::vector<std::thread> threads;
+  for(int t = 0; t < THREADS; t++)
+  {
+    threads.emplace_back([&]() {
+      for(int i = 0; i < TREES_PER_THREAD; i++)
+      {
+        auto tree = registry->createTree("MainTree");
+        if(tree.tickWhileRunning() == NodeStatus::SUCCESS &&
+           tree.rootBlackboard()->get<int>("counter") == 3)
+        {
+          success_count++;
+        }
+      }
+    });
+  }
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+  ASSERT_EQ(success_count, THREADS * TREES_PER_THREAD);
+}
+
+TEST(BehaviorTreeFactory, ReloadTree)
+{
+  const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" value:=1 " />
+      <SubTree ID="Stage" name="stage" _autoremap="true" />
+      <SubTree ID="Finish" name="finish" />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Stage">
+    <Sequence>
+      <SubTree ID="Inner" name="inner" />
+      <AlwaysSuccess/>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Inner">
+    <Script code=" local:=42 " />
+  </BehaviorTree>
+
+  <BehaviorTree ID="Finish">
+    <KeepRunningUntilFailure>
+      <AlwaysSuccess/>
+    </KeepRunningUntilFailure>
+  </BehaviorTree>
+</root> )";
+
+  const char* new_stage = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="Stage">
+    <Sequence>
+      <SubTree ID="Inner" name="inner" />
+      <Script code=" value:=2 " />
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  const char* new_main = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <SubTree ID="Stage" name="stage" _autoremap="true" />
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto tree = factory.createTree("MainTree");
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+
+  auto findSubtree = [&](const std::string& path) {
+    for(const auto& subtree : tree.subtrees)
+    {
+      if(subtree->instance_name == path)
+      {
+        return subtree;
+      }
+    }
+    return Tree::Subtree::Ptr();
+  };
+  const auto root_blackboard = tree.rootBlackboard();
+  const auto stage = findSubtree("stage");
+  const auto finish = findSubtree("finish");
+  const auto old_inner_blackboard = findSubtree("stage/inner")->blackboard;
+
+  // same definitions: nothing to do
+  ASSERT_TRUE(factory.reloadTree(tree, xml_text).empty());
+  ASSERT_EQ(findSubtree("stage"), stage);
+
+  auto rebuilt = factory.reloadTree(tree, new_stage);
+  ASSERT_EQ(rebuilt, std::vector<std::string>{ "stage" });
+  ASSERT_EQ(tree.subtrees.size(), 4);
+
+  // the rest of the tree is untouched and still RUNNING
+  ASSERT_EQ(findSubtree("finish"), finish);
+  ASSERT_EQ(finish->nodes.front()->status(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.rootNode()->status(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.rootBlackboard(), root_blackboard);
+
+  // the stage is new, but it has the same blackboard
+  auto new_stage_subtree = findSubtree("stage");
+  ASSERT_NE(new_stage_subtree, stage);
+  ASSERT_EQ(new_stage_subtree->blackboard, stage->blackboard);
+  ASSERT_EQ(new_stage_subtree->nodes.size(), 3);
+  auto new_inner = findSubtree("stage/inner");
+  ASSERT_NE(new_inner->blackboard, old_inner_blackboard);
+  ASSERT_EQ(new_inner->blackboard->get<int>("local"), 42);
+
+  // the Sequence continues from the RUNNING child
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(root_blackboard->get<int>("value"), 1);
+
+  rebuilt = factory.reloadTree(tree, new_main);
+  ASSERT_EQ(rebuilt, std::vector<std::string>{ "" });
+  ASSERT_EQ(tree.subtrees.size(), 3);
+  ASSERT_EQ(tree.subtrees.front()->tree_ID, "MainTree");
+  ASSERT_EQ(tree.rootBlackboard(), root_blackboard);
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(root_blackboard->get<int>("value"), 2);
+}
+
+TEST(BehaviorTreeFactory, DeferredPlugin)
+{
+  const auto cache =
+      std::filesystem::temp_directory_path() / "btcpp_test_dummy_nodes_manifest.xml";
+  std::filesystem::remove(cache);
+
+  const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <CheckBattery/>
+      <SaySomething message="hello"/>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  {
+    // no cache yet: the plugin is loaded and the cache is written
+    BehaviorTreeFactory factory;
+    factory.registerFromPluginManifest(BT_TEST_PLUGIN, cache);
+    ASSERT_TRUE(std::filesystem::exists(cache));
+    ASSERT_FALSE(factory.loadDeferredPlugin("SaySomething"));
+    ASSERT_EQ(factory.findManifest("SaySomething")->ports.at("message").type(),
+              typeid(std::string));
+  }
+
+  BehaviorTreeFactory factory;
+  factory.registerFromPluginManifest(BT_TEST_PLUGIN, cache);
+  ASSERT_EQ(factory.builders().count("CheckBattery"), 1);
+  const auto& manifest = factory.manifests().at("SaySomething");
+  ASSERT_EQ(manifest.type, NodeType::ACTION);
+  ASSERT_EQ(manifest.ports.at("message").direction(), PortDirection::INPUT);
+  // the type of the port is unknown until the plugin is loaded
+  ASSERT_NE(manifest.ports.at("message").type(), typeid(std::string));
+
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto tree = factory.createTree("MainTree");
+  // the manifests of the factory are never replaced
+  ASSERT_EQ(&factory.manifests().at("SaySomething"), &manifest);
+  ASSERT_NE(manifest.ports.at("message").type(), typeid(std::string));
+  ASSERT_NE(factory.findManifest("SaySomething"), &manifest);
+  ASSERT_EQ(factory.findManifest("SaySomething")->ports.at("message").type(),
+            typeid(std::string));
+  ASSERT_FALSE(factory.loadDeferredPlugin("CheckBattery"));
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+
+  std::filesystem::remove(cache);
+
+  // the cache can not be written
+  BehaviorTreeFactory other_factory;
+  const auto invalid_cache = cache.parent_path() / "btcpp_missing_dir" / "manifest.xml";
+  ASSERT_THROW(other_factory.registerFromPluginManifest(BT_TEST_PLUGIN, invalid_cache),
+               RuntimeError);
+  ASSERT_EQ(other_factory.builders().count("CheckBattery"), 1);
+}
+
+TEST(BehaviorTreeFactory, DeferredPluginWithEnums)
+{
+  const auto cache =
+      std::filesystem::temp_directory_path() / "btcpp_test_enums_plugin_manifest.xml";
+  std::filesystem::remove(cache);
+
+  const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <PaintBlue color="{color}"/>
+      <ScriptCondition code="color == BLUE"/>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  // without and with the cache
+  for(int i = 0; i < 2; i++)
+  {
+    BehaviorTreeFactory factory;
+    factory.registerFromPluginManifest(BT_TEST_ENUMS_PLUGIN, cache);
+    ASSERT_TRUE(std::filesystem::exists(cache));
+    // the enums are registered before the plugin is loaded
+    ASSERT_EQ(factory.scriptingEnums().at("BLUE"), 3);
+    ASSERT_EQ(factory.scriptingEnums().at("RED"), 1);
+
+    factory.registerBehaviorTreeFromText(xml_text);
+    auto tree = factory.createTree("MainTree");
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    ASSERT_EQ(tree.rootBlackboard()->get<int>("color"), 3);
+  }
+  std::filesystem::remove(cache);
+}
+
 KeyValueVector makeTestMetadata()
 {
   return {
@@ -730,3 +730,39 @@ TEST(PortTest, DefaultWronglyOverriden)
   // This is correct
   ASSERT_NO_THROW(auto tree = factory.createTreeFromText(xml_txt_correct));
 }
+
+TEST(PortTest, ConvertNumberLists)
+{
+  EXPECT_EQ(splitStringCount("", ';'), 0u);
+  EXPECT_EQ(splitStringCount("1", ';'), 1u);
+  EXPECT_EQ(splitStringCount("1;2;3", ';'), 3u);
+  EXPECT_EQ(splitStringCount("1;2;3;", ';'), 3u);
+  EXPECT_EQ(splitString("1;;3", ';').size(), splitStringCount("1;;3", ';'));
+
+  const auto doubles = convertFromString<std::vector<double>>("1.5;-2;3e2; 4.25;+5");
+  ASSERT_EQ(doubles.size(), 5u);
+  EXPECT_EQ(doubles[0], 1.5);
+  EXPECT_EQ(doubles[1], -2.0);
+  EXPECT_EQ(doubles[2], 300.0);
+  EXPECT_EQ(doubles[3], 4.25);
+  EXPECT_EQ(doubles[4], 5.0);
+
+  const auto ints = convertFromString<std::vector<int>>("1;-2;300;");
+  ASSERT_EQ(ints.size(), 3u);
+  EXPECT_EQ(ints[0], 1);
+  EXPECT_EQ(ints[1], -2);
+  EXPECT_EQ(ints[2], 300);
+
+  const auto strings = convertFromString<std::vector<std::string>>("a;bb;ccc");
+  ASSERT_EQ(strings.size(), 3u);
+  EXPECT_EQ(strings[2], "ccc");
+
+  EXPECT_TRUE(convertFromString<std::vector<double>>("").empty());
+  EXPECT_ANY_THROW(convertFromString<std::vector<double>>("1.0;foo"));
+  EXPECT_ANY_THROW(convertFromString<std::vector<int>>("1;;2"));
+
+  // values that std::from_chars doesn't accept are still converted
+  EXPECT_EQ(convertFromString<double>("0x10"), 16.0);
+  EXPECT_EQ(convertFromString<double>("2.5 "), 2.5);
+  EXPECT_EQ(convertFromString<float>("-0.5"), -0.5f);
+}
@@ -505,3 +505,102 @@ TEST(Preconditions, SkippedSequence)
   status = tree.tickWhileRunning();
   ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
 }
+
+// the pre and post conditions can be modified by a derived class
+class EditableConditions : public SyncActionNode
+{
+public:
+  EditableConditions(const std::string& name, const NodeConfig& config)
+    : SyncActionNode(name, config)
+  {}
+
+  static PortsList providedPorts()
+  {
+    return {};
+  }
+
+  void setPreCondition(PreCond cond, const std::string& script)
+  {
+    preConditionsScripts()[size_t(cond)] =
+        script.empty() ? ScriptFunction() : ParseScript(script).value();
+  }
+
+  void setPostCondition(PostCond cond, const std::string& script)
+  {
+    postConditionsScripts()[size_t(cond)] =
+        script.empty() ? ScriptFunction() : ParseScript(script).value();
+  }
+
+private:
+  NodeStatus tick() override
+  {
+    return NodeStatus::SUCCESS;
+  }
+};
+
+TEST(Preconditions, ScriptsChangedAfterConstruction)
+{
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<EditableConditions>("EditableConditions");
+
+  const std::string xml_text = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence>
+                <Script code = "A:=0; B:=0" />
+                <EditableConditions/>
+            </Sequence>
+        </BehaviorTree>
+    </root>)";
+
+  auto tree = factory.createTreeFromText(xml_text);
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+
+  EditableConditions* node = nullptr;
+  tree.applyVisitor([&node](TreeNode* visited) {
+    if(auto editable = dynamic_cast<EditableConditions*>(visited))
+    {
+      node = editable;
+    }
+  });
+  ASSERT_NE(node, nullptr);
+
+  // add conditions to a node that had none
+  node->setPreCondition(PreCond::FAILURE_IF, "A==0");
+  node->setPostCondition(PostCond::ON_FAILURE, "B+=1");
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::FAILURE);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("B"), 1);
+
+  // remove a condition and add another one
+  node->setPreCondition(PreCond::FAILURE_IF, "");
+  node->setPostCondition(PostCond::ON_SUCCESS, "B+=10");
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  // B is reset by the Script at every tick
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("B"), 10);
+}
+
+TEST(Preconditions, SomeConditionSlots)
+{
+  BehaviorTreeFactory factory;
+
+  const std::string xml_text = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence>
+                <Script code = "A:=1; F:=0; S:=0; P:=0" />
+                <AlwaysFailure _successIf="A==1"/>
+                <AlwaysSuccess _onFailure="F:=1" _post="P:=1"/>
+                <ForceSuccess>
+                    <AlwaysFailure _onSuccess="S:=1" _onFailure="F:=2"/>
+                </ForceSuccess>
+                <AlwaysSuccess _skipIf="A!=1" _onSuccess="S:=3"/>
+            </Sequence>
+        </BehaviorTree>
+    </root>)";
+
+  auto tree = factory.createTreeFromText(xml_text);
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("F"), 2);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("P"), 1);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("S"), 3);
+}
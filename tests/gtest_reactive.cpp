@@ -184,3 +184,125 @@ TEST(Reactive, TwoAsyncNodesInReactiveSequence)
 
   EXPECT_ANY_THROW(auto tree = factory.createTreeFromText(reactive_xml_text));
 }
+
+TEST(Reactive, ActiveChildren)
+{
+  // more than 64 children, to use more than one word of the bitset
+  std::string xml_text = R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree">
+                              <ReactiveSequence name="root">)";
+  for(int i = 0; i < 69; i++)
+  {
+    xml_text += R"(<Script code="ticks += 1"/>)";
+  }
+  xml_text += R"(<KeepRunningUntilFailure _onHalted="halted := true">
+                   <AlwaysSuccess/>
+                 </KeepRunningUntilFailure>
+               </ReactiveSequence></BehaviorTree></root>)";
+
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+  tree.rootBlackboard()->set("ticks", 0);
+  tree.rootBlackboard()->set("halted", false);
+  auto root = dynamic_cast<BT::ControlNode*>(tree.rootNode());
+  ASSERT_NE(root, nullptr);
+  ASSERT_EQ(root->childrenCount(), 70);
+
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("ticks"), 69);
+  // the children that succeeded were halted, because the last one is RUNNING
+  for(size_t i = 0; i < 69; i++)
+  {
+    ASSERT_FALSE(root->isChildActive(i));
+    ASSERT_EQ(root->child(i)->status(), NodeStatus::IDLE);
+  }
+  ASSERT_TRUE(root->isChildActive(69));
+
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("ticks"), 2 * 69);
+  ASSERT_FALSE(tree.rootBlackboard()->get<bool>("halted"));
+
+  root->haltChildren();
+  ASSERT_FALSE(root->isChildActive(69));
+  ASSERT_EQ(root->child(69)->status(), NodeStatus::IDLE);
+  ASSERT_TRUE(tree.rootBlackboard()->get<bool>("halted"));
+}
+
+class CheckBattery : public BT::ConditionNode
+{
+public:
+  CheckBattery(const std::string& name, const BT::NodeConfig& config, int* ticks)
+    : BT::ConditionNode(name, config), ticks_(ticks)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<int>("level", "{battery}", "") };
+  }
+
+  NodeStatus tick() override
+  {
+    (*ticks_)++;
+    return getInput<int>("level").value() > 20 ? NodeStatus::SUCCESS :
+                                                 NodeStatus::FAILURE;
+  }
+
+private:
+  int* ticks_;
+};
+
+TEST(Reactive, MemoizedConditions)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <ReactiveSequence>
+      <CheckBattery _memoize="true"/>
+      <ScriptCondition code="distance < max_distance" _memoize="true"/>
+      <CheckBattery level="{battery}"/>
+      <KeepRunningUntilFailure>
+        <AlwaysSuccess/>
+      </KeepRunningUntilFailure>
+    </ReactiveSequence>
+  </BehaviorTree>
+</root>)";
+
+  int ticks = 0;
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<CheckBattery>("CheckBattery", &ticks);
+  auto tree = factory.createTreeFromText(xml_text);
+  auto bb = tree.rootBlackboard();
+  bb->set("battery", 50);
+  bb->set("distance", 1);
+  bb->set("max_distance", 10);
+
+  // the second CheckBattery is not memoized
+  for(int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(ticks, 1 + 5);
+
+  // writing an entry invalidates the result, even if the value is the same
+  bb->set("battery", 50);
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 6 + 2);
+
+  bb->set("max_distance", 0);
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::FAILURE);
+  bb->set("max_distance", 10);
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+
+  bb->set("battery", 10);
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::FAILURE);
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::FAILURE);
+
+  // only the conditions without side effects can be memoized
+  ASSERT_ANY_THROW((void)factory.createTreeFromText(R"(
+    <root BTCPP_format="4"><BehaviorTree>
+      <AlwaysSuccess _memoize="true"/>
+    </BehaviorTree></root>)"));
+  ASSERT_ANY_THROW((void)factory.createTreeFromText(R"(
+    <root BTCPP_format="4"><BehaviorTree>
+      <ScriptCondition code="value := 1" _memoize="true"/>
+    </BehaviorTree></root>)"));
+}
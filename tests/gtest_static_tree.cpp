@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/static_tree.h"
+
+using namespace BT;
+
+namespace
+{
+struct IsBatteryOk
+{
+  static PortsList providedPorts()
+  {
+    return { InputPort<int>("battery") };
+  }
+
+  NodeStatus tick(TreeNode& node)
+  {
+    const int battery = node.getInput<int>("battery").value();
+    return battery > 20 ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+  }
+};
+
+struct Charge
+{
+  static PortsList providedPorts()
+  {
+    return { BidirectionalPort<int>("battery") };
+  }
+
+  NodeStatus tick(TreeNode& node)
+  {
+    node.setOutput("battery", 100);
+    return NodeStatus::SUCCESS;
+  }
+};
+
+// returns RUNNING once, then SUCCESS
+struct MoveTo
+{
+  static PortsList providedPorts()
+  {
+    return { OutputPort<int>("moves") };
+  }
+
+  NodeStatus tick(TreeNode& node)
+  {
+    if(!running)
+    {
+      running = true;
+      return NodeStatus::RUNNING;
+    }
+    running = false;
+    moves++;
+    node.setOutput("moves", moves);
+    return NodeStatus::SUCCESS;
+  }
+
+  void halt()
+  {
+    running = false;
+    halted++;
+    node_halted = true;
+  }
+
+  bool running = false;
+  int moves = 0;
+  int halted = 0;
+  static inline bool node_halted = false;
+};
+
+struct Fail
+{
+  NodeStatus tick(TreeNode&)
+  {
+    return NodeStatus::FAILURE;
+  }
+};
+
+using ChargeAndMove =
+    Static::Sequence<Static::Fallback<IsBatteryOk, Charge>, MoveTo>;
+
+}  // namespace
+
+TEST(StaticTree, ProvidedPorts)
+{
+  auto ports = StaticTree<ChargeAndMove>::providedPorts();
+  ASSERT_EQ(ports.size(), 2);
+  ASSERT_EQ(ports.count("battery"), 1);
+  ASSERT_EQ(ports.count("moves"), 1);
+  ASSERT_EQ(ports.at("battery").direction(), PortDirection::INOUT);
+}
+
+TEST(StaticTree, EmbeddedInXML)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <ChargeAndMove battery="{battery}" moves="{moves}" />
+      <ChargeAndMove battery="{battery}" moves="{moves}" />
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<StaticTree<ChargeAndMove>>("ChargeAndMove");
+  auto tree = factory.createTreeFromText(xml_text);
+  tree.rootBlackboard()->set("battery", 10);
+
+  // MoveTo returns RUNNING once in each instance
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("battery"), 100);
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("moves"), 1);
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("moves"), 1);
+
+  // halt the running leaf
+  MoveTo::node_halted = false;
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  tree.haltTree();
+  ASSERT_TRUE(MoveTo::node_halted);
+}
+
+TEST(StaticTree, ControlFlow)
+{
+  Static::Sequence<MoveTo, MoveTo> sequence;
+  auto bb = Blackboard::create();
+  NodeConfig config;
+  config.blackboard = bb;
+  config.output_ports["moves"] = "{moves}";
+  StaticTree<Static::ForceSuccess<Fail>> dummy("dummy", config);
+
+  // the running child is resumed, the previous one is not ticked again
+  ASSERT_EQ(sequence.tick(dummy), NodeStatus::RUNNING);
+  ASSERT_EQ(sequence.tick(dummy), NodeStatus::RUNNING);
+  ASSERT_EQ(sequence.tick(dummy), NodeStatus::SUCCESS);
+  ASSERT_EQ(bb->get<int>("moves"), 1);
+
+  Static::Fallback<Fail, Static::Inverter<Fail>, MoveTo> fallback;
+  ASSERT_EQ(fallback.tick(dummy), NodeStatus::SUCCESS);
+
+  Static::Sequence<Static::ForceFailure<MoveTo>, Fail> failure;
+  ASSERT_EQ(failure.tick(dummy), NodeStatus::RUNNING);
+  ASSERT_EQ(failure.tick(dummy), NodeStatus::FAILURE);
+
+  ASSERT_EQ(dummy.executeTick(), NodeStatus::SUCCESS);
+}
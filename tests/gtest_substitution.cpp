@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/utils/wildcard_index.h"
 
 using namespace BT;
 
@@ -49,3 +50,46 @@ TEST(Substitution, Parser)
 
   ASSERT_EQ(*std::get_if<std::string>(&rules.at("actionC")), "NotAConfig");
 }
+
+TEST(Substitution, WildcardIndex)
+{
+  WildcardIndex index;
+  ASSERT_EQ(index.add("main/move"), 0);
+  ASSERT_EQ(index.add("main/sub*"), 1);
+  ASSERT_EQ(index.add("*/move"), 2);
+  ASSERT_EQ(index.add("main/*"), 3);
+  ASSERT_EQ(index.add("main/sub*"), 1);
+
+  ASSERT_EQ(index.firstMatch("main/move"), 0);
+  ASSERT_EQ(index.firstMatch("main/subtree/move"), 1);
+  ASSERT_EQ(index.firstMatch("other/move"), 2);
+  ASSERT_EQ(index.firstMatch("main/other"), 3);
+  ASSERT_EQ(index.firstMatch("other/stop"), WildcardIndex::NONE);
+
+  ASSERT_EQ(index.find("*/move"), 2);
+  ASSERT_EQ(index.find("other/move"), WildcardIndex::NONE);
+}
+
+TEST(Substitution, FirstRuleWins)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <AlwaysSuccess name="first"/>
+      <AlwaysSuccess name="second"/>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  factory.addSubstitutionRule("sec*", "AlwaysSuccess");
+  factory.addSubstitutionRule("second", "AlwaysFailure");
+  ASSERT_EQ(factory.createTree("MainTree").tickWhileRunning(), NodeStatus::SUCCESS);
+
+  factory.clearSubstitutionRules();
+  factory.addSubstitutionRule("second", "AlwaysFailure");
+  factory.addSubstitutionRule("sec*", "AlwaysSuccess");
+  ASSERT_EQ(factory.createTree("MainTree").tickWhileRunning(), NodeStatus::FAILURE);
+}
@@ -726,3 +726,326 @@ TEST(SubTree, SubtreeNameNotRegistered)
   ASSERT_ANY_THROW(auto tree = factory.createTreeFromText(xml_text));
   ASSERT_ANY_THROW(factory.registerBehaviorTreeFromText(xml_text));
 }
+
+TEST(SubTree, LazySubtree)
+{
+  // clang-format off
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" counter:=0 " />
+      <SubTree ID="Increment" value="{counter}" _lazy="true" />
+      <Fallback>
+        <ScriptCondition code=" counter == limit " />
+        <SubTree ID="Nested" name="contingency" counter="{counter}" _lazy="true" />
+      </Fallback>
+      <AlwaysSuccess name="last" />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Script code=" value += 1 " />
+  </BehaviorTree>
+
+  <BehaviorTree ID="Nested">
+    <Sequence>
+      <SubTree ID="Increment" value="{counter}" _lazy="true" />
+      <SubTree ID="Increment" value="{counter}" />
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+  // clang-format on
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  std::vector<std::string> eager_nodes;
+  {
+    std::string eager_xml = xml_text;
+    size_t pos;
+    while((pos = eager_xml.find(R"( _lazy="true")")) != std::string::npos)
+    {
+      eager_xml.erase(pos, 13);
+    }
+    BehaviorTreeFactory eager_factory;
+    eager_factory.registerBehaviorTreeFromText(eager_xml);
+    auto tree = eager_factory.createTree("MainTree");
+    tree.applyVisitor([&](const TreeNode* node) {
+      eager_nodes.push_back(node->fullPath() + " " + std::to_string(node->UID()));
+    });
+    ASSERT_EQ(eager_nodes.size(), 13);
+  }
+
+  auto CollectNodes = [](const Tree& tree) {
+    std::vector<std::string> nodes;
+    tree.applyVisitor([&](const TreeNode* node) {
+      nodes.push_back(node->fullPath() + " " + std::to_string(node->UID()));
+    });
+    return nodes;
+  };
+
+  // the subtrees are created when ticked, with the same UIDs and paths
+  {
+    auto tree = factory.createTree("MainTree");
+    ASSERT_EQ(CollectNodes(tree).size(), 7);
+    ASSERT_EQ(tree.subtrees.size(), 1);
+
+    // moved to a different instance before the first tick
+    Tree moved_tree = std::move(tree);
+    moved_tree.rootBlackboard()->set("limit", 1);
+    ASSERT_EQ(moved_tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    ASSERT_EQ(moved_tree.rootBlackboard()->get<int>("counter"), 1);
+    ASSERT_EQ(CollectNodes(moved_tree).size(), 8);
+    ASSERT_EQ(moved_tree.subtrees.size(), 2);
+
+    moved_tree.instantiateLazySubtrees();
+    ASSERT_EQ(CollectNodes(moved_tree), eager_nodes);
+    ASSERT_EQ(moved_tree.subtrees.size(), 5);
+  }
+
+  // the contingency runs when the condition fails
+  {
+    auto tree = factory.createTree("MainTree");
+    tree.rootBlackboard()->set("limit", 1);
+    auto nested = tree.getNodesByPath<SubTreeNode>("contingency");
+    ASSERT_EQ(nested.size(), 1);
+    ASSERT_TRUE(static_cast<const SubTreeNode*>(nested.front())->isLazy());
+
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    ASSERT_EQ(tree.rootBlackboard()->get<int>("counter"), 1);
+    tree.rootBlackboard()->set("limit", 5);
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    ASSERT_EQ(tree.rootBlackboard()->get<int>("counter"), 3);
+    ASSERT_EQ(CollectNodes(tree), eager_nodes);
+  }
+}
+
+TEST(SubTree, NodePathIndex)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence name="root">
+      <AlwaysSuccess name="move_base"/>
+      <SubTree ID="Arm" name="left"/>
+      <SubTree ID="Arm" name="right" _lazy="true"/>
+      <AlwaysSuccess name="move_arm"/>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Arm">
+    <Sequence name="arm">
+      <AlwaysSuccess name="move_joint"/>
+      <AlwaysSuccess name="grasp"/>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto tree = factory.createTree("MainTree");
+
+  auto paths = [](const std::vector<const TreeNode*>& nodes) {
+    std::vector<std::string> out;
+    for(auto node : nodes)
+    {
+      out.push_back(node->fullPath());
+    }
+    return out;
+  };
+
+  using Paths = std::vector<std::string>;
+  ASSERT_EQ(paths(tree.getNodesByPath("move_base")), Paths{ "move_base" });
+  // same order of Tree::subtrees
+  ASSERT_EQ(paths(tree.getNodesByPath("move_*")), (Paths{ "move_base", "move_arm" }));
+  ASSERT_EQ(paths(tree.getNodesByPath("left/*")), (Paths{ "left/arm", "left/move_joint",
+                                                          "left/grasp" }));
+  ASSERT_EQ(paths(tree.getNodesByPath("*/move_?oint")), Paths{ "left/move_joint" });
+  ASSERT_EQ(tree.getNodesByPath<SubTreeNode>("*").size(), 2);
+  ASSERT_TRUE(tree.getNodesByPath("move").empty());
+
+  auto grasp = tree.getNodeByPath("left/grasp");
+  ASSERT_NE(grasp, nullptr);
+  ASSERT_EQ(tree.getNodeByUID(grasp->UID()), grasp);
+  ASSERT_EQ(tree.getNodeByPath("right/grasp"), nullptr);
+  ASSERT_EQ(tree.getNodeByUID(1000), nullptr);
+
+  // the lazy subtree is added to the index when created, also after a move
+  Tree moved_tree = std::move(tree);
+  moved_tree.instantiateLazySubtrees();
+  ASSERT_NE(moved_tree.getNodeByPath("right/grasp"), nullptr);
+  ASSERT_EQ(paths(moved_tree.getNodesByPath("*/move_joint")),
+            (Paths{ "left/move_joint", "right/move_joint" }));
+}
+
+TEST(SubTree, NodePathIndexDuplicateNames)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence name="root">
+      <AlwaysSuccess name="move"/>
+      <AlwaysFailure name="move_away"/>
+      <ForceSuccess name="move">
+        <AlwaysFailure/>
+      </ForceSuccess>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto tree = factory.createTree("MainTree");
+
+  // the named nodes share their fullPath()
+  const auto nodes = tree.getNodesByPath("move");
+  ASSERT_EQ(nodes.size(), 2);
+  ASSERT_EQ(nodes[0]->registrationName(), "AlwaysSuccess");
+  ASSERT_EQ(nodes[1]->registrationName(), "ForceSuccess");
+  ASSERT_EQ(tree.getNodesByPath("move*").size(), 3);
+  ASSERT_EQ(tree.getNodeByPath("move"), nodes[0]);
+}
+
+TEST(SubTree, PreOrderNodes)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <Sequence name="root">
+      <Inverter name="not">
+        <AlwaysFailure name="fail"/>
+      </Inverter>
+      <SubTree ID="Arm" name="left"/>
+      <SubTree ID="Arm" name="right" _lazy="true"/>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Arm">
+    <Sequence name="arm">
+      <AlwaysSuccess name="grasp"/>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto tree = factory.createTree("MainTree");
+
+  auto root = tree.rootNode();
+  ASSERT_EQ(root->children().size(), 3);
+  ASSERT_EQ(root->children()[0]->name(), "not");
+  ASSERT_EQ(root->children()[0]->children().size(), 1);
+  ASSERT_TRUE(tree.getNodeByPath("fail")->children().empty());
+  // the lazy SubTree has no child yet
+  ASSERT_TRUE(tree.getNodeByPath("right")->children().empty());
+
+  auto names = [&tree]() {
+    std::vector<std::string> out;
+    for(auto node : tree.preOrderNodes())
+    {
+      out.push_back(node->fullPath());
+    }
+    return out;
+  };
+  using Paths = std::vector<std::string>;
+  ASSERT_EQ(names(),
+            (Paths{ "root", "not", "fail", "left", "left/arm", "left/grasp", "right" }));
+
+  tree.instantiateLazySubtrees();
+  ASSERT_EQ(names(), (Paths{ "root", "not", "fail", "left", "left/arm", "left/grasp",
+                             "right", "right/arm", "right/grasp" }));
+
+  // applyVisitor and buildSerializedStatusSnapshot use the same order
+  std::vector<const TreeNode*> visited;
+  tree.applyVisitor([&visited](const TreeNode* node) { visited.push_back(node); });
+  ASSERT_EQ(visited.size(), tree.preOrderNodes().size());
+  SerializedTreeStatus snapshot;
+  buildSerializedStatusSnapshot(tree.rootNode(), snapshot);
+  ASSERT_EQ(snapshot.size(), visited.size());
+  for(size_t i = 0; i < visited.size(); i++)
+  {
+    ASSERT_EQ(visited[i], tree.preOrderNodes()[i]);
+    ASSERT_EQ(snapshot[i].first, visited[i]->UID());
+  }
+}
+
+namespace
+{
+// the constructor throws while "fail" is true
+class FragileAction : public SyncActionNode
+{
+public:
+  FragileAction(const std::string& name, const NodeConfig& config)
+    : SyncActionNode(name, config)
+  {
+    if(fail)
+    {
+      throw RuntimeError("FragileAction can't be created");
+    }
+  }
+
+  static PortsList providedPorts()
+  {
+    return {};
+  }
+
+  NodeStatus tick() override
+  {
+    return NodeStatus::SUCCESS;
+  }
+
+  static bool fail;
+};
+bool FragileAction::fail = false;
+
+const char* fragile_xml = R"(
+<root BTCPP_format="4" >
+  <BehaviorTree ID="MainTree">
+    <SubTree ID="Fragile" name="lazy" _lazy="true"/>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Fragile">
+    <Sequence>
+      <AlwaysSuccess/>
+      <FragileAction/>
+    </Sequence>
+  </BehaviorTree>
+</root> )";
+}  // namespace
+
+TEST(SubTree, LazySubtreeFailedBuild)
+{
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<FragileAction>("FragileAction");
+  factory.registerBehaviorTreeFromText(fragile_xml);
+  auto tree = factory.createTree("MainTree");
+  const auto* lazy = static_cast<const SubTreeNode*>(tree.getNodeByPath("lazy"));
+
+  // the nodes created before the failure are destroyed
+  FragileAction::fail = true;
+  ASSERT_THROW(tree.tickOnce(), RuntimeError);
+  ASSERT_TRUE(lazy->isLazy());
+  ASSERT_EQ(lazy->child(), nullptr);
+  ASSERT_THROW(tree.tickOnce(), RuntimeError);
+
+  // it can be tried again
+  FragileAction::fail = false;
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_FALSE(lazy->isLazy());
+  ASSERT_EQ(tree.preOrderNodes().size(), 4);
+}
+
+TEST(SubTree, LazySubtreeOutlivesFactory)
+{
+  Tree tree;
+  {
+    BehaviorTreeFactory factory;
+    factory.registerNodeType<FragileAction>("FragileAction");
+    factory.registerBehaviorTreeFromText(fragile_xml);
+    tree = factory.createTree("MainTree");
+  }
+  // the subtree is created after the factory was destroyed
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.preOrderNodes().size(), 4);
+}
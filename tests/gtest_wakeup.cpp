@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include "behaviortree_cpp/bt_factory.h"
 
 using namespace BT;
@@ -50,3 +51,424 @@ TEST(WakeUp, BasicTest)
 
   ASSERT_LT(dT, 25);
 }
+
+TEST(WakeUp, TickOnceIfNeeded)
+{
+  static const char* xml_text = R"(
+
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <ReactiveSequence>
+            <CountTicks/>
+            <Sleep msec="50"/>
+        </ReactiveSequence>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  int ticks = 0;
+  factory.registerSimpleCondition("CountTicks", [&](TreeNode&) {
+    ticks++;
+    return NodeStatus::SUCCESS;
+  });
+
+  Tree tree = factory.createTreeFromText(xml_text);
+
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 1);
+  // nothing changed: Sleep emits the wake-up signal when the timer expires
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 1);
+
+  tree.rootBlackboard()->set("value", 42);
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 2);
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 2);
+
+  tree.markDirty();
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 3);
+
+  // woken up by the timer
+  tree.sleep(std::chrono::milliseconds(200));
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::SUCCESS);
+  ASSERT_EQ(ticks, 4);
+}
+
+// completed when "release" is true
+class WaitReleaseAction : public BT::ThreadedAction
+{
+public:
+  WaitReleaseAction(const std::string& name, const BT::NodeConfig& config)
+    : ThreadedAction(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+  BT::NodeStatus tick() override
+  {
+    while(!release && !isHaltRequested())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  static std::atomic_bool release;
+};
+
+std::atomic_bool WaitReleaseAction::release = false;
+
+TEST(WakeUp, TickOnceIfNeededThreadedAction)
+{
+  static const char* xml_text = R"(
+
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <ReactiveSequence>
+            <CountTicks/>
+            <WaitReleaseAction/>
+        </ReactiveSequence>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  int ticks = 0;
+  factory.registerSimpleCondition("CountTicks", [&](TreeNode&) {
+    ticks++;
+    return NodeStatus::SUCCESS;
+  });
+  factory.registerNodeType<WaitReleaseAction>("WaitReleaseAction");
+  WaitReleaseAction::release = false;
+
+  Tree tree = factory.createTreeFromText(xml_text);
+
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  ASSERT_EQ(ticks, 1);
+  // the thread emits the wake-up signal when completed
+  for(int i = 0; i < 10; i++)
+  {
+    ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(ticks, 1);
+
+  WaitReleaseAction::release = true;
+  tree.sleep(std::chrono::milliseconds(500));
+  ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::SUCCESS);
+  ASSERT_EQ(ticks, 2);
+}
+
+class PollingAction : public BT::StatefulActionNode
+{
+public:
+  PollingAction(const std::string& name, const BT::NodeConfig& config)
+    : StatefulActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+  BT::NodeStatus onStart() override
+  {
+    return BT::NodeStatus::RUNNING;
+  }
+
+  BT::NodeStatus onRunning() override
+  {
+    ticks++;
+    return BT::NodeStatus::RUNNING;
+  }
+
+  void onHalted() override
+  {}
+
+  int ticks = 0;
+};
+
+TEST(WakeUp, TickOnceIfNeededPolling)
+{
+  static const char* xml_text = R"(
+
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <Parallel success_count="2">
+            <Sleep msec="1000"/>
+            <PollingAction/>
+        </Parallel>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<PollingAction>("PollingAction");
+
+  Tree tree = factory.createTreeFromText(xml_text);
+  PollingAction* action = nullptr;
+  tree.applyVisitor([&](TreeNode* node) {
+    if(auto ptr = dynamic_cast<PollingAction*>(node))
+    {
+      action = ptr;
+    }
+  });
+  ASSERT_NE(action, nullptr);
+  ASSERT_FALSE(action->waitsForEvents());
+
+  // PollingAction doesn't wait for events: the tree is always ticked
+  for(int i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(tree.tickOnceIfNeeded(), NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(action->ticks, 2);
+  tree.haltTree();
+}
+
+TEST(WakeUp, TickPeriod)
+{
+  static const char* xml_text = R"(
+
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <ReactiveSequence>
+            <CountFast/>
+            <ReactiveSequence _period="100ms">
+                <CountSlow/>
+                <KeepRunningUntilFailure>
+                    <AlwaysSuccess/>
+                </KeepRunningUntilFailure>
+            </ReactiveSequence>
+        </ReactiveSequence>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  int fast_ticks = 0;
+  int slow_ticks = 0;
+  factory.registerSimpleCondition("CountFast", [&](TreeNode&) {
+    fast_ticks++;
+    return NodeStatus::SUCCESS;
+  });
+  factory.registerSimpleCondition("CountSlow", [&](TreeNode&) {
+    slow_ticks++;
+    return NodeStatus::SUCCESS;
+  });
+
+  Tree tree = factory.createTreeFromText(xml_text);
+
+  for(int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(fast_ticks, 5);
+  ASSERT_EQ(slow_ticks, 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(fast_ticks, 6);
+  ASSERT_EQ(slow_ticks, 2);
+
+  // a halted subtree is ticked again immediately
+  tree.haltTree();
+  ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(fast_ticks, 7);
+  ASSERT_EQ(slow_ticks, 3);
+
+  static const char* xml_invalid = R"(
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <AlwaysSuccess _period="fast"/>
+    </BehaviorTree>
+</root> )";
+  ASSERT_THROW(factory.createTreeFromText(xml_invalid), RuntimeError);
+  for(const char* period : { "inf", "nan", "-5", "1e300s", "0.1us" })
+  {
+    const std::string xml_period = std::string(R"(
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <AlwaysSuccess _period=")") + period + R"("/>
+    </BehaviorTree>
+</root> )";
+    ASSERT_THROW(factory.createTreeFromText(xml_period), RuntimeError) << period;
+  }
+
+  // ThreadedAction doesn't use TreeNode::executeTick()
+  static const char* xml_threaded = R"(
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <WaitReleaseAction _period="10ms"/>
+    </BehaviorTree>
+</root> )";
+  factory.registerNodeType<WaitReleaseAction>("WaitReleaseAction");
+  ASSERT_THROW(factory.createTreeFromText(xml_threaded), RuntimeError);
+}
+
+TEST(WakeUp, TickPeriodStatusChanges)
+{
+  static const char* xml_text = R"(
+
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <Sequence>
+            <AlwaysSuccess name="slow" _period="1s"/>
+            <AlwaysSuccess/>
+        </Sequence>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  Tree tree = factory.createTreeFromText(xml_text);
+  const auto slow = tree.getNodeByPath("slow");
+  ASSERT_NE(slow, nullptr);
+
+  std::vector<std::pair<NodeStatus, NodeStatus>> changes;
+  auto subscriber = slow->subscribeToStatusChange(
+      [&](TimePoint, const TreeNode&, NodeStatus prev, NodeStatus status) {
+        changes.push_back({ prev, status });
+      });
+
+  for(int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(tree.tickExactlyOnce(), NodeStatus::SUCCESS);
+  }
+  // reset to IDLE by the Sequence, but not set to SUCCESS again between periods
+  using Changes = std::vector<std::pair<NodeStatus, NodeStatus>>;
+  ASSERT_EQ(changes, (Changes{ { NodeStatus::IDLE, NodeStatus::SUCCESS },
+                               { NodeStatus::SUCCESS, NodeStatus::IDLE } }));
+}
+
+TEST(WakeUp, TickStatistics)
+{
+  using std::chrono::microseconds;
+  TickStatistics stats(10);
+  ASSERT_EQ(stats.durationPercentile(50).count(), 0);
+
+  for(int i = 1; i <= 100; i++)
+  {
+    stats.addTick(microseconds(i), i > 95);
+  }
+  ASSERT_EQ(stats.tickCount(), 100);
+  ASSERT_EQ(stats.overrunCount(), 5);
+  ASSERT_EQ(stats.maxDuration().count(), 100);
+  // only the last 10 ticks
+  ASSERT_EQ(stats.durationPercentile(0).count(), 91);
+  ASSERT_EQ(stats.durationPercentile(50).count(), 95);
+  ASSERT_EQ(stats.durationPercentile(90).count(), 99);
+  ASSERT_EQ(stats.durationPercentile(100).count(), 100);
+
+  stats.addJitter(microseconds(-30));
+  stats.addJitter(microseconds(10));
+  ASSERT_EQ(stats.maxJitter().count(), 30);
+  ASSERT_EQ(stats.meanJitter().count(), 20);
+
+  stats.reset();
+  ASSERT_EQ(stats.tickCount(), 0);
+  ASSERT_EQ(stats.maxJitter().count(), 0);
+}
+
+// RUNNING for 9 ticks; the 5th one lasts more than two periods
+class SlowFifthTick : public BT::StatefulActionNode
+{
+public:
+  SlowFifthTick(const std::string& name, const BT::NodeConfig& config)
+    : StatefulActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+  BT::NodeStatus onStart() override
+  {
+    return onRunning();
+  }
+
+  BT::NodeStatus onRunning() override
+  {
+    ticks++;
+    if(ticks == 5)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }
+    return ticks < 10 ? BT::NodeStatus::RUNNING : BT::NodeStatus::SUCCESS;
+  }
+
+  void onHalted() override
+  {}
+
+  int ticks = 0;
+};
+
+TEST(WakeUp, TickAtFixedRate)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <SlowFifthTick/>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<SlowFifthTick>("SlowFifthTick");
+  Tree tree = factory.createTreeFromText(xml_text);
+
+  std::vector<TickOverrun> overruns;
+  FixedRateOptions options;
+  options.period = std::chrono::milliseconds(10);
+  options.budget = std::chrono::milliseconds(8);
+  options.overrun_policy = OverrunPolicy::USE_CALLBACK;
+  options.on_overrun = [&](const TickOverrun& info) { overruns.push_back(info); };
+
+  auto t1 = std::chrono::steady_clock::now();
+  ASSERT_EQ(tree.tickAtFixedRate(options), NodeStatus::SUCCESS);
+  auto t2 = std::chrono::steady_clock::now();
+
+  // a loaded machine may add more overruns: only the 5th tick is certain
+  const auto& stats = tree.tickStatistics();
+  ASSERT_EQ(stats.tickCount(), 10);
+  ASSERT_GE(stats.overrunCount(), 1);
+  ASSERT_GE(stats.missedDeadlineCount(), 2);
+  ASSERT_GE(overruns.size(), 1);
+  ASSERT_TRUE(std::any_of(overruns.begin(), overruns.end(), [](const auto& overrun) {
+    return overrun.missed_deadlines >= 2;
+  }));
+  ASSERT_GE(stats.maxDuration(), std::chrono::milliseconds(25));
+
+  // at least 9 periods plus the 2 skipped ones: the schedule doesn't drift
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+  ASSERT_GE(elapsed.count(), 100);
+  ASSERT_LT(elapsed.count(), 500);
+
+  options.on_overrun = nullptr;
+  ASSERT_THROW(tree.tickAtFixedRate(options), RuntimeError);
+}
+
+TEST(WakeUp, TickAtFixedRateSkip)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4">
+    <BehaviorTree ID="MainTree">
+        <SlowFifthTick/>
+    </BehaviorTree>
+</root> )";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<SlowFifthTick>("SlowFifthTick");
+  Tree tree = factory.createTreeFromText(xml_text);
+
+  FixedRateOptions options;
+  options.period = std::chrono::milliseconds(10);
+  options.overrun_policy = OverrunPolicy::SKIP;
+  ASSERT_EQ(tree.tickAtFixedRate(options), NodeStatus::SUCCESS);
+
+  // the two periods skipped after the 5th tick are not jitter (20 ms)
+  const auto& stats = tree.tickStatistics();
+  ASSERT_EQ(stats.tickCount(), 10);
+  ASSERT_GE(stats.missedDeadlineCount(), 2);
+  ASSERT_LT(stats.maxJitter(), std::chrono::milliseconds(15));
+}
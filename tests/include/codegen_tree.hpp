@@ -0,0 +1,264 @@
+// Generated by bt4_codegen from the tree "CodegenTree". Do not edit.
+// It creates the same nodes as TreeTemplate::instantiate(), without the XML.
+#pragma once
+
+#include "behaviortree_cpp/bt_factory.h"
+
+inline BT::Tree CreateCodegenTree(const BT::BehaviorTreeFactory& factory,
+    BT::Blackboard::Ptr blackboard = BT::Blackboard::create())
+{
+  using namespace BT;
+  if(!blackboard)
+  {
+    throw RuntimeError("CreateCodegenTree needs a non-empty blackboard");
+  }
+  const auto& manifests = factory.manifests();
+  Tree tree;
+  Blackboard::Ptr bb[3] = { blackboard };
+  TreeNode* nodes[17] = {};
+
+  // create the entry or check that it has the same type of the port
+  auto create_entry = [](Blackboard& bb, const std::string& key,
+                         const PortInfo& info) {
+    if(auto prev = bb.entryInfo(key))
+    {
+      if(prev->isStronglyTyped() && info.isStronglyTyped() &&
+         prev->type() != info.type() && prev->type() != typeid(std::string))
+      {
+        throw RuntimeError("The creation of the tree failed because the port [", key,
+                           "] was initially created with type [", demangle(prev->type()),
+                           "] and, later type [", demangle(info.type()),
+                           "] was used somewhere else.");
+      }
+    }
+    else
+    {
+      bb.createEntry(key, info);
+    }
+  };
+
+  auto add_node = [&tree](TreeNode::Ptr node, TreeNode* parent,
+                           size_t subtree) {
+    if(auto control = dynamic_cast<ControlNode*>(parent))
+    {
+      control->addChild(node.get());
+    }
+    else if(auto decorator = dynamic_cast<DecoratorNode*>(parent))
+    {
+      decorator->setChild(node.get());
+    }
+    TreeNode* ptr = node.get();
+    tree.subtrees[subtree]->nodes.push_back(std::move(node));
+    return ptr;
+  };
+
+  // subtree "CodegenTree"
+  {
+    auto subtree = std::make_shared<Tree::Subtree>();
+    subtree->blackboard = bb[0];
+    subtree->instance_name = "";
+    subtree->tree_ID = "CodegenTree";
+    tree.subtrees.push_back(subtree);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("Sequence");
+    config.uid = tree.getUID();
+    config.path = "Sequence::1";
+    auto node = factory.instantiateTreeNode("Sequence", "Sequence", config);
+    nodes[0] = add_node(std::move(node), nullptr, 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("Script");
+    config.uid = tree.getUID();
+    config.path = "Script::2";
+    config.input_ports = { { "code", " count:=0; total:=0 " } };
+    auto node = factory.instantiateTreeNode("Script", "Script", config);
+    nodes[1] = add_node(std::move(node), nodes[0], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("ReactiveFallback");
+    config.uid = tree.getUID();
+    config.path = "ReactiveFallback::3";
+    auto node = factory.instantiateTreeNode("ReactiveFallback", "ReactiveFallback", config);
+    nodes[2] = add_node(std::move(node), nodes[0], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("ScriptCondition");
+    config.uid = tree.getUID();
+    config.path = "ScriptCondition::4";
+    config.input_ports = { { "code", " stop " } };
+    auto node = factory.instantiateTreeNode("ScriptCondition", "ScriptCondition", config);
+    nodes[3] = add_node(std::move(node), nodes[2], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("Sequence");
+    config.uid = tree.getUID();
+    config.path = "Sequence::5";
+    auto node = factory.instantiateTreeNode("Sequence", "Sequence", config);
+    nodes[4] = add_node(std::move(node), nodes[2], 0);
+  }
+  create_entry(*bb[0], "cycles",
+               manifests.at("Repeat").ports.at("num_cycles"));
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("Repeat");
+    config.uid = tree.getUID();
+    config.path = "Repeat::6";
+    config.input_ports = { { "num_cycles", "{cycles}" } };
+    auto node = factory.instantiateTreeNode("Repeat", "Repeat", config);
+    nodes[5] = add_node(std::move(node), nodes[4], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.uid = tree.getUID();
+    config.path = "Accumulate::7";
+    config.input_ports = { { "step", "2" }, { "sum", "{total}" }, { "value", "{count}" } };
+    auto node = factory.instantiateTreeNode("Accumulate", "SubTree", config);
+    static_cast<SubTreeNode*>(node.get())->setSubtreeID("Accumulate");
+    nodes[6] = add_node(std::move(node), nodes[5], 0);
+  }
+
+  bb[1] = Blackboard::create(bb[0]);
+  bb[1]->enableAutoRemapping(false);
+  bb[1]->enableAutoRemapping(false);
+  bb[1]->set("step", std::string("2"));
+  bb[1]->enableAutoRemapping(false);
+  bb[1]->addSubtreeRemapping("sum", "total");
+  bb[1]->addSubtreeRemapping("value", "count");
+
+  // subtree "Accumulate"
+  {
+    auto subtree = std::make_shared<Tree::Subtree>();
+    subtree->blackboard = bb[1];
+    subtree->instance_name = "Accumulate::7";
+    subtree->tree_ID = "Accumulate";
+    tree.subtrees.push_back(subtree);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[1];
+    config.manifest = &manifests.at("Fallback");
+    config.uid = tree.getUID();
+    config.path = "Accumulate::7/Fallback::8";
+    auto node = factory.instantiateTreeNode("Fallback", "Fallback", config);
+    nodes[7] = add_node(std::move(node), nodes[6], 1);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[1];
+    config.manifest = &manifests.at("ScriptCondition");
+    config.uid = tree.getUID();
+    config.path = "Accumulate::7/ScriptCondition::9";
+    config.input_ports = { { "code", " value >= 10 " } };
+    config.post_conditions = { { PostCond::ON_SUCCESS, "sum += 100" } };
+    auto node = factory.instantiateTreeNode("ScriptCondition", "ScriptCondition", config);
+    nodes[8] = add_node(std::move(node), nodes[7], 1);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[1];
+    config.manifest = &manifests.at("Script");
+    config.uid = tree.getUID();
+    config.path = "Accumulate::7/Script::10";
+    config.input_ports = { { "code", " value += 1; sum += value " } };
+    auto node = factory.instantiateTreeNode("Script", "Script", config);
+    nodes[9] = add_node(std::move(node), nodes[7], 1);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("Inverter");
+    config.uid = tree.getUID();
+    config.path = "Inverter::11";
+    auto node = factory.instantiateTreeNode("Inverter", "Inverter", config);
+    nodes[10] = add_node(std::move(node), nodes[4], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("ScriptCondition");
+    config.uid = tree.getUID();
+    config.path = "ScriptCondition::12";
+    config.input_ports = { { "code", " total > limit " } };
+    config.post_conditions = { { PostCond::ON_FAILURE, "result:='below'" } };
+    auto node = factory.instantiateTreeNode("ScriptCondition", "ScriptCondition", config);
+    nodes[11] = add_node(std::move(node), nodes[10], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.manifest = &manifests.at("Script");
+    config.uid = tree.getUID();
+    config.path = "Script::13";
+    config.input_ports = { { "code", " result:='done' " } };
+    config.pre_conditions = { { PreCond::SKIP_IF, "cycles == 0" } };
+    auto node = factory.instantiateTreeNode("Script", "Script", config);
+    nodes[12] = add_node(std::move(node), nodes[4], 0);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[0];
+    config.uid = tree.getUID();
+    config.path = "Report::14";
+    auto node = factory.instantiateTreeNode("Report", "SubTree", config);
+    static_cast<SubTreeNode*>(node.get())->setSubtreeID("Report");
+    nodes[13] = add_node(std::move(node), nodes[0], 0);
+  }
+
+  bb[2] = Blackboard::create(bb[0]);
+  bb[2]->enableAutoRemapping(true);
+
+  // subtree "Report"
+  {
+    auto subtree = std::make_shared<Tree::Subtree>();
+    subtree->blackboard = bb[2];
+    subtree->instance_name = "Report::14";
+    subtree->tree_ID = "Report";
+    tree.subtrees.push_back(subtree);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[2];
+    config.manifest = &manifests.at("Sequence");
+    config.uid = tree.getUID();
+    config.path = "Report::14/Sequence::15";
+    auto node = factory.instantiateTreeNode("Sequence", "Sequence", config);
+    nodes[14] = add_node(std::move(node), nodes[13], 2);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[2];
+    config.manifest = &manifests.at("Script");
+    config.uid = tree.getUID();
+    config.path = "Report::14/Script::16";
+    config.input_ports = { { "code", " report := result + ':' " } };
+    auto node = factory.instantiateTreeNode("Script", "Script", config);
+    nodes[15] = add_node(std::move(node), nodes[14], 2);
+  }
+  {
+    NodeConfig config;
+    config.blackboard = bb[2];
+    config.manifest = &manifests.at("AlwaysSuccess");
+    config.uid = tree.getUID();
+    config.path = "Report::14/end";
+    config.post_conditions = { { PostCond::ALWAYS, "finished:=true" } };
+    auto node = factory.instantiateTreeNode("end", "AlwaysSuccess", config);
+    nodes[16] = add_node(std::move(node), nodes[14], 2);
+  }
+
+  tree.initialize();
+  tree.manifests = manifests;
+  return tree;
+}
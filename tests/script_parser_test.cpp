@@ -1,11 +1,13 @@
 #include <gtest/gtest.h>
 
 #include "behaviortree_cpp/scripting/operators.hpp"
+#include "behaviortree_cpp/scripting/script_bytecode.hpp"
 #include "behaviortree_cpp/bt_factory.h"
 #include "../sample_nodes/dummy_nodes.h"
 #include "test_helper.hpp"
 
 #include <lexy/input/string_input.hpp>
+#include <algorithm>
 
 BT::Any GetScriptResult(BT::Ast::Environment& environment, const char* text)
 {
@@ -441,3 +443,421 @@ TEST(ParserTest, NewLine)
   ASSERT_EQ(tree.rootBlackboard()->get<int>("A"), 5);
   ASSERT_EQ(tree.rootBlackboard()->get<int>("B"), 6);
 }
+
+TEST(ParserTest, BytecodeCompilation)
+{
+  auto Compiled = [](const char* text) {
+    auto input = lexy::zstring_input<lexy::utf8_encoding>(text);
+    auto result = lexy::parse<BT::Grammar::stmt>(input, lexy_ext::report_error);
+    auto exprs = LEXY_MOV(result).value();
+    return BT::Ast::ScriptBytecode::compile(exprs.front()) != nullptr;
+  };
+
+  EXPECT_TRUE(Compiled("A > 3 && B < 2"));
+  EXPECT_TRUE(Compiled("A == RED"));
+  EXPECT_TRUE(Compiled("x := A * 2 + (B - 1) / 3"));
+  EXPECT_TRUE(Compiled("A += 1 + B"));
+  EXPECT_TRUE(Compiled("A > 1 ? B + 1 : B - 1"));
+  EXPECT_TRUE(Compiled("0 < A < 10"));
+  EXPECT_TRUE(Compiled("!A || ~B"));
+
+  // these produce a string or a value with the type of their operand
+  EXPECT_FALSE(Compiled("msg := 'hello'"));
+  EXPECT_FALSE(Compiled("A .. B"));
+  EXPECT_FALSE(Compiled("A"));
+  EXPECT_FALSE(Compiled("x := A"));
+  EXPECT_FALSE(Compiled("A > 1 ? 'yes' : 'no'"));
+  EXPECT_FALSE(Compiled("msg == 'hello'"));
+}
+
+TEST(ParserTest, BytecodeLinking)
+{
+  auto Parse = [](const char* text) {
+    auto input = lexy::zstring_input<lexy::utf8_encoding>(text);
+    auto result = lexy::parse<BT::Grammar::stmt>(input, lexy_ext::report_error);
+    return LEXY_MOV(result).value().front();
+  };
+
+  BT::Ast::Environment env = { BT::Blackboard::create(),
+                               std::make_shared<BT::EnumsTable>() };
+  env.enums->insert({ "LOW_BATTERY", 20 });
+  env.enums->insert({ "IDLE", 0 });
+  env.enums->insert({ "RED", 1 });
+  env.enums->insert({ "BLUE", 3 });
+
+  // enums and constants are folded
+  auto folded =
+      BT::Ast::ScriptBytecode::compile(Parse("RED + BLUE * 2"), env.enums.get());
+  ASSERT_TRUE(folded);
+  ASSERT_EQ(folded->instructions().size(), 1);
+  EXPECT_EQ(folded->instructions()[0].op, BT::Ast::ScriptBytecode::OpCode::LOAD_CONST);
+
+  auto expr = Parse("battery > LOW_BATTERY && state == IDLE");
+  auto unlinked = BT::Ast::ScriptBytecode::compile(expr);
+  auto linked = BT::Ast::ScriptBytecode::compile(expr, env.enums.get());
+  ASSERT_TRUE(unlinked && linked);
+  auto CountLoadVar = [](const BT::Ast::ScriptBytecode& program) {
+    return std::count_if(program.instructions().begin(), program.instructions().end(),
+                         [](const auto& inst) {
+                           return inst.op == BT::Ast::ScriptBytecode::OpCode::LOAD_VAR;
+                         });
+  };
+  EXPECT_EQ(CountLoadVar(*unlinked), 4);
+  EXPECT_EQ(CountLoadVar(*linked), 2);
+
+  // bind the entries once, then reuse them
+  BT::Ast::ScriptBytecode::Bindings bindings;
+  BT::Any result;
+  env.vars->set("battery", 50);
+  env.vars->set("state", 0);
+  ASSERT_TRUE(linked->execute(env, result, &bindings));
+  EXPECT_EQ(result.cast<double>(), 1.0);
+  auto battery_entry = env.vars->getEntry("battery");
+  EXPECT_EQ(bindings.entries[0], battery_entry);
+
+  env.vars->set("battery", 10);
+  ASSERT_TRUE(linked->execute(env, result, &bindings));
+  EXPECT_EQ(result.cast<double>(), 0.0);
+  EXPECT_EQ(bindings.entries[0], battery_entry);
+
+  // the entry is removed and created again: bindings must be refreshed
+  env.vars->unset("battery");
+  EXPECT_FALSE(linked->execute(env, result, &bindings));
+  env.vars->set("battery", 30);
+  ASSERT_TRUE(linked->execute(env, result, &bindings));
+  EXPECT_EQ(result.cast<double>(), 1.0);
+  EXPECT_NE(bindings.entries[0], battery_entry);
+
+  // different blackboard
+  BT::Ast::Environment other_env = { BT::Blackboard::create(), env.enums };
+  other_env.vars->set("battery", 10);
+  other_env.vars->set("state", 0);
+  ASSERT_TRUE(linked->execute(other_env, result, &bindings));
+  EXPECT_EQ(result.cast<double>(), 0.0);
+
+  // different table of enums: can't be executed
+  BT::Ast::Environment no_enums = { env.vars, std::make_shared<BT::EnumsTable>() };
+  EXPECT_FALSE(linked->execute(no_enums, result, &bindings));
+
+  // the same, through ParseScript, reusing the same function
+  auto script = BT::ParseScript("x := battery + 1; y := x * 2").value();
+  ASSERT_EQ(script(env).cast<double>(), 62.0);
+  env.vars->set("battery", 1);
+  ASSERT_EQ(script(env).cast<double>(), 4.0);
+  env.vars->unset("x");
+  env.vars->unset("y");
+  ASSERT_EQ(script(env).cast<double>(), 4.0);
+  ASSERT_EQ(env.vars->get<double>("x"), 2.0);
+
+  auto failing = BT::ParseScript("battery + 1").value();
+  ASSERT_EQ(failing(env).cast<double>(), 2.0);
+  env.vars->unset("battery");
+  EXPECT_ANY_THROW(failing(env));
+}
+
+// The bytecode and the AST must produce the same results and the same errors
+TEST(ParserTest, BytecodeMatchesAST)
+{
+  auto MakeEnvironment = []() {
+    BT::Ast::Environment env = { BT::Blackboard::create(),
+                                 std::make_shared<BT::EnumsTable>() };
+    env.enums->insert({ "RED", 1 });
+    env.enums->insert({ "BLUE", 3 });
+    env.vars->set("i", 7);
+    env.vars->set("d", 2.5);
+    env.vars->set("u", uint64_t(12));
+    env.vars->set("b", true);
+    env.vars->set("s", std::string("hello"));
+    env.vars->set("num_str", std::string("42"));
+    env.vars->set("big", int64_t(1) << 60);
+    return env;
+  };
+
+  const std::vector<std::string> scripts = {
+    "i + d",
+    "i * 2 - d / 4",
+    "-i",
+    "~i",
+    "~d",
+    "!b",
+    "!i",
+    "i & 3",
+    "i | 8",
+    "i ^ 5",
+    "d & 1",
+    "i && b",
+    "i || 0",
+    "d && 1",
+    "i < d",
+    "1 < i < 10",
+    "1 < i < 5",
+    "i == 7",
+    "d != 2.5",
+    "d == 2.5000001",
+    "i > d > 0",
+    "RED == 1",
+    "i == RED + 6",
+    "i > 5 ? d : i",
+    "i > 5 ? d + 1 : i * 2",
+    "i < 5 ? d + 1 : i * 2",
+    "b ? 1.0 + 1 : 2.0 * 3",
+    "(i > 3) && (d < 1)",
+    "u + 1",
+    "u - 20",
+    "1 / 0",
+    "s == 'hello'",
+    "num_str + 1",
+    "num_str < 50",
+    "s + 1",
+    "s < 1",
+    "big + 1",
+    "big & 1",
+    "undefined_var + 1",
+    "x := i + d",
+    "x := i * 2; y := x + 1; y * 2",
+    "x = 3 + 1",
+    "i += 3",
+    "i = i * 2",
+    "i = d * 2",
+    "i = d + 0",
+    "d /= 2",
+    "d -= i * 2",
+    "s += 1 + 1",
+    "s = 1 + 1",
+    "b = i > 3",
+    "u *= 2 + 0",
+    "x := RED + BLUE; x == 4",
+  };
+
+  for(const auto& script : scripts)
+  {
+    auto env_ast = MakeEnvironment();
+    auto env_vm = MakeEnvironment();
+
+    BT::Any ast_result;
+    BT::Any vm_result;
+    bool ast_failed = false;
+    bool vm_failed = false;
+    try
+    {
+      ast_result = GetScriptResult(env_ast, script.c_str());
+    }
+    catch(std::exception&)
+    {
+      ast_failed = true;
+    }
+    try
+    {
+      vm_result = BT::ParseScript(script).value()(env_vm);
+    }
+    catch(std::exception&)
+    {
+      vm_failed = true;
+    }
+
+    ASSERT_EQ(ast_failed, vm_failed) << script;
+    if(ast_failed)
+    {
+      continue;
+    }
+    ASSERT_EQ(ast_result.type(), vm_result.type()) << script;
+    if(ast_result.isNumber())
+    {
+      EXPECT_EQ(ast_result.cast<double>(), vm_result.cast<double>()) << script;
+    }
+    else if(ast_result.isString())
+    {
+      EXPECT_EQ(ast_result.cast<std::string>(), vm_result.cast<std::string>())
+          << script;
+    }
+
+    for(const auto& key : env_ast.vars->getKeys())
+    {
+      auto ast_value = env_ast.vars->getAnyLocked(std::string(key));
+      auto vm_value = env_vm.vars->getAnyLocked(std::string(key));
+      ASSERT_TRUE(vm_value) << script;
+      ASSERT_EQ(ast_value->type(), vm_value->type()) << script << " " << key;
+      double ast_number = 0;
+      double vm_number = 0;
+      if(ast_value->tryCastNumber(ast_number))
+      {
+        ASSERT_TRUE(vm_value->tryCastNumber(vm_number)) << script;
+        EXPECT_EQ(ast_number, vm_number) << script << " " << key;
+      }
+    }
+  }
+}
+
+TEST(ParserTest, ScriptCache)
+{
+  BT::ClearScriptCache();
+  BT::BehaviorTreeFactory factory;
+
+  const std::string xml_text = R"(
+  <root BTCPP_format="4" >
+    <BehaviorTree ID="Main">
+      <Sequence>
+        <SubTree ID="Counter" value="{A}"/>
+        <SubTree ID="Counter" value="{B}"/>
+        <SubTree ID="Counter" value="{C}"/>
+        <Script code="msg := 'hello'" />
+        <Script code="{dynamic_code}" />
+      </Sequence>
+    </BehaviorTree>
+
+    <BehaviorTree ID="Counter">
+      <Sequence>
+        <Script code="value := 0" />
+        <Script code="value += 1" _successIf="value > 10" />
+      </Sequence>
+    </BehaviorTree>
+  </root> )";
+
+  factory.registerBehaviorTreeFromText(xml_text);
+  auto blackboard = BT::Blackboard::create();
+  blackboard->set("dynamic_code", std::string("X := 1"));
+  auto tree = factory.createTree("Main", blackboard);
+  // parsed once, even if used by multiple nodes
+  ASSERT_EQ(BT::ScriptCacheSize(), 5);
+
+  ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("X"), 1);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("A"), 1);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("C"), 1);
+
+  // a script read from the blackboard can still change
+  tree.rootBlackboard()->set("dynamic_code", std::string("X := 2"));
+  ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("X"), 2);
+  ASSERT_EQ(BT::ScriptCacheSize(), 6);
+
+  // the cache is shared by different factories
+  BT::BehaviorTreeFactory other_factory;
+  other_factory.registerBehaviorTreeFromText(xml_text);
+  auto other_tree = other_factory.createTree("Counter");
+  ASSERT_EQ(BT::ScriptCacheSize(), 6);
+}
+
+TEST(ParserTest, ScriptCacheEviction)
+{
+  BT::ClearScriptCache();
+  size_t max_size = 0;
+  for(int i = 0; i < 5000; i++)
+  {
+    ASSERT_TRUE(BT::ParseScript("x := " + std::to_string(i)));
+    max_size = std::max(max_size, BT::ScriptCacheSize());
+  }
+  // the oldest scripts are removed one at a time, not all together
+  ASSERT_LT(max_size, 5000);
+  ASSERT_EQ(BT::ScriptCacheSize(), max_size);
+  BT::ClearScriptCache();
+}
+
+TEST(ParserTest, ArrayFunctions)
+{
+  BT::Ast::Environment env = { BT::Blackboard::create(), {} };
+
+  std::vector<double> scan;
+  std::vector<int> costs;
+  for(int i = 0; i < 203; i++)
+  {
+    scan.push_back(10.0 + std::sin(i) * 5.0);
+    costs.push_back(i % 7);
+  }
+  scan[150] = 0.3;
+  env.vars->set("scan", scan);
+  env.vars->set("costs", costs);
+  env.vars->set("weights", std::vector<float>(costs.size(), 0.5f));
+  env.vars->set("text", std::string("4;-2;7.5"));
+  env.vars->set("empty", std::vector<double>());
+  env.vars->set("threshold", 0.5);
+
+  auto Eval = [&](const char* text) {
+    auto func = BT::ParseScript(text);
+    if(!func)
+    {
+      throw BT::RuntimeError(func.error());
+    }
+    return func.value()(env).cast<double>();
+  };
+
+  double expected_sum = 0;
+  for(auto v : scan)
+  {
+    expected_sum += v;
+  }
+  EXPECT_NEAR(Eval("sum(scan)"), expected_sum, 1e-9);
+  EXPECT_EQ(Eval("min(scan)"), 0.3);
+  EXPECT_EQ(Eval("max(scan)"), *std::max_element(scan.begin(), scan.end()));
+  EXPECT_EQ(Eval("sum(costs)"), 609);
+  EXPECT_EQ(Eval("max(costs) + min(costs)"), 6);
+  EXPECT_EQ(Eval("dot(costs, weights)"), 304.5);
+  EXPECT_EQ(Eval("dot(costs, costs)"), 2639);
+  EXPECT_EQ(Eval("sum(text)"), 9.5);
+  EXPECT_EQ(Eval("min(text)"), -2);
+  EXPECT_EQ(Eval("sum(empty)"), 0);
+  EXPECT_EQ(Eval("min(3, threshold, 7)"), 0.5);
+  EXPECT_EQ(Eval("max(3, threshold, 7)"), 7);
+
+  EXPECT_EQ(Eval("any(scan < threshold)"), 1);
+  EXPECT_EQ(Eval("any(scan < 0.2)"), 0);
+  EXPECT_EQ(Eval("any(0.2 > scan)"), 0);
+  EXPECT_EQ(Eval("all(scan > 0)"), 1);
+  EXPECT_EQ(Eval("all(scan >= 1)"), 0);
+  EXPECT_EQ(Eval("count(costs == 6)"), 29);
+  EXPECT_EQ(Eval("count(6 != costs)"), 174);
+  EXPECT_EQ(Eval("all(empty > 0)"), 1);
+  EXPECT_EQ(Eval("any(empty > 0)"), 0);
+
+  // combined with other expressions
+  EXPECT_EQ(Eval("min(scan) < 0.5 && count(costs > 3) > 10"), 1);
+  EXPECT_EQ(Eval("x := sum(costs) / 2; x"), 304.5);
+
+  // a function name can still be used as a variable
+  env.vars->set("min", 42);
+  EXPECT_EQ(Eval("min + 1"), 43);
+
+  EXPECT_FALSE(BT::ParseScript("median(scan)"));
+  EXPECT_FALSE(BT::ParseScript("any(scan)"));
+  EXPECT_FALSE(BT::ParseScript("dot(scan)"));
+  EXPECT_FALSE(BT::ValidateScript("sum(scan, costs)"));
+  EXPECT_ANY_THROW(Eval("min(empty)"));
+  EXPECT_ANY_THROW(Eval("dot(scan, text)"));
+  EXPECT_ANY_THROW(Eval("sum(threshold)"));
+  EXPECT_ANY_THROW(Eval("min(scan, 3)"));
+  EXPECT_ANY_THROW(Eval("sum(missing)"));
+  EXPECT_ANY_THROW(Eval("any(scan > costs)"));
+
+  // in the XML
+  BT::BehaviorTreeFactory factory;
+  const std::string xml_text = R"xml(
+  <root BTCPP_format="4" >
+    <BehaviorTree ID="Main">
+      <Sequence>
+        <AlwaysSuccess _failureIf="any(scan &lt; 0.5)" />
+        <Script code="too_close := true" />
+      </Sequence>
+    </BehaviorTree>
+  </root> )xml";
+  auto blackboard = BT::Blackboard::create();
+  blackboard->set("scan", scan);
+  auto tree = factory.createTreeFromText(xml_text, blackboard);
+  ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::FAILURE);
+  scan[150] = 1.0;
+  blackboard->set("scan", scan);
+  ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+}
+
+TEST(ParserTest, EmptyScriptNode)
+{
+  // an empty Script does nothing
+  BT::BehaviorTreeFactory factory;
+  const std::string xml_text = R"(
+  <root BTCPP_format="4" >
+    <BehaviorTree ID="Main">
+      <Script code="" />
+    </BehaviorTree>
+  </root> )";
+  auto tree = factory.createTreeFromText(xml_text);
+  ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+}
@@ -0,0 +1,25 @@
+#include "behaviortree_cpp/bt_factory.h"
+
+// Plugin used by the tests: it registers a node and some scripting enums
+
+namespace
+{
+enum class Color
+{
+  RED = 1,
+  GREEN = 2,
+  BLUE = 3
+};
+}  // namespace
+
+BT_REGISTER_NODES(factory)
+{
+  factory.registerScriptingEnums<Color>();
+  factory.registerSimpleAction(
+      "PaintBlue",
+      [](BT::TreeNode& node) {
+        node.setOutput("color", static_cast<int>(Color::BLUE));
+        return BT::NodeStatus::SUCCESS;
+      },
+      { BT::OutputPort<int>("color") });
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "behaviortree_cpp/bt_factory.h"
+
+// Generate a C++ header with a function that creates the tree without
+// parsing the XML (see TreeTemplate::generateCode).
+// The nodes, their ports and the scripts are the same of the interpreted tree:
+// only the creation of the tree is compiled, not its execution.
+
+static void PrintUsage(const char* program)
+{
+  printf("Usage: %s [--plugin library]... [--tree tree_ID] [--function name] "
+         "input.xml output.hpp\n\n"
+         "  --plugin    load the nodes registered by a plugin\n"
+         "  --tree      ID of the tree; default: the main tree\n"
+         "  --function  name of the generated function; default: Create<tree_ID>\n\n"
+         "The generated function builds the tree without parsing the XML. The nodes\n"
+         "are created by the builders of the factory and ticked like in the\n"
+         "interpreted tree: the control flow is not devirtualized, the ports are\n"
+         "not bound to typed fields and the scripts are not compiled to C++.\n",
+         program);
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> plugins;
+  std::vector<std::string> files;
+  std::string tree_ID;
+  std::string function_name;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(strcmp(argv[i], "--plugin") == 0 && i + 1 < argc)
+    {
+      plugins.push_back(argv[++i]);
+    }
+    else if(strcmp(argv[i], "--tree") == 0 && i + 1 < argc)
+    {
+      tree_ID = argv[++i];
+    }
+    else if(strcmp(argv[i], "--function") == 0 && i + 1 < argc)
+    {
+      function_name = argv[++i];
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if(files.size() != 2)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    BT::BehaviorTreeFactory factory;
+    for(const auto& plugin : plugins)
+    {
+      factory.registerFromPlugin(plugin);
+    }
+    factory.registerBehaviorTreeFromFile(files[0]);
+
+    auto tree_template = factory.compileTree(tree_ID);
+    if(function_name.empty())
+    {
+      function_name = "Create" + tree_template->treeID();
+      for(auto& c : function_name)
+      {
+        if(!std::isalnum(static_cast<unsigned char>(c)))
+        {
+          c = '_';
+        }
+      }
+    }
+
+    std::ofstream output(files[1]);
+    output << tree_template->generateCode(function_name);
+    if(!output)
+    {
+      std::cerr << "Can't write the file: " << files[1] << std::endl;
+      return 1;
+    }
+  }
+  catch(std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
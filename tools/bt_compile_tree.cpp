@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "behaviortree_cpp/bt_factory.h"
+
+// Compile a tree into the binary format that can be loaded with
+// BehaviorTreeFactory::loadCompiledTreeFromFile().
+
+static void PrintUsage(const char* program)
+{
+  printf("Usage: %s [--plugin library]... [--tree tree_ID] input.xml output\n\n"
+         "  --plugin  load the nodes registered by a plugin\n"
+         "  --tree    ID of the tree to compile; default: the main tree\n",
+         program);
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> plugins;
+  std::vector<std::string> files;
+  std::string tree_ID;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(strcmp(argv[i], "--plugin") == 0 && i + 1 < argc)
+    {
+      plugins.push_back(argv[++i]);
+    }
+    else if(strcmp(argv[i], "--tree") == 0 && i + 1 < argc)
+    {
+      tree_ID = argv[++i];
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if(files.size() != 2)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    BT::BehaviorTreeFactory factory;
+    for(const auto& plugin : plugins)
+    {
+      factory.registerFromPlugin(plugin);
+    }
+    factory.registerBehaviorTreeFromFile(files[0]);
+
+    auto tree_template = factory.compileTree(tree_ID);
+    const std::string buffer = tree_template->serialize();
+
+    std::ofstream output(files[1], std::ios::binary);
+    output.write(buffer.data(), std::streamsize(buffer.size()));
+    if(!output)
+    {
+      std::cerr << "Can't write the file: " << files[1] << std::endl;
+      return 1;
+    }
+    std::cout << "Tree [" << tree_template->treeID() << "] with "
+              << tree_template->nodesCount() << " nodes: " << buffer.size()
+              << " bytes" << std::endl;
+  }
+  catch(std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
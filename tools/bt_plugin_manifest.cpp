@@ -3,16 +3,26 @@
 #include <unordered_map>
 #include <unordered_set>
 #include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/xml_parsing.h"
 
 int main(int argc, char* argv[])
 {
-  if(argc != 2)
+  // with --xml, print the cache used by BehaviorTreeFactory::registerFromPluginManifest
+  const bool xml_output = (argc == 3 && std::string(argv[1]) == "--xml");
+  if(argc != 2 && !xml_output)
   {
-    printf("Wrong number of command line arguments\nUsage: %s [filename]\n", argv[0]);
+    printf("Wrong number of command line arguments\nUsage: %s [--xml] [filename]\n",
+           argv[0]);
     return 1;
   }
 
   BT::BehaviorTreeFactory factory;
+  if(xml_output)
+  {
+    factory.registerFromPlugin(argv[2]);
+    std::cout << BT::writePluginManifestXML(factory) << std::endl;
+    return 0;
+  }
 
   std::unordered_set<std::string> default_nodes;
   for(auto& it : factory.manifests())